@@ -3,34 +3,114 @@
 #include "../core/move.h"
 #include "../core/attacks.h"
 #include "position.h"
-#include <vector>
 
-// list of moves
-using MoveList = std::vector<Move>;
+// ==================== LEGAL MOVE GENERATION ===========================
+// Only legal moves are generated, using the checkers and pin masks the
+// position keeps for the side to move:
+//  - in double check only the king moves
+//  - in single check every other piece must land on checkMask (capture
+//    the checker or block between it and the king)
+//  - a pinned piece stays on its pin ray, pinMaskHV or pinMaskD
+//  - the king never steps onto an attacked square
+// En passant can uncover the king along the rank, it is tested by
+// looking at the board as it will be after the capture.
+//
+// GenType picks a subset at compile time, every piece generator is shared:
+//  CAPTURES      captures, en passant, every promotion capture and the
+//                quiet queen promotion
+//  QUIETS        the other moves: quiets, castling, quiet under-promotions
+//  EVASIONS      every legal move while in check
+//  QUIET_CHECKS  quiet non-promotion moves that give check
+//  LEGAL         every legal move, CAPTURES + QUIETS
+// ============================================================================
+
+enum GenType {
+    CAPTURES,
+    QUIETS,
+    EVASIONS,
+    QUIET_CHECKS,
+    LEGAL
+};
 
 class MoveGenerator {
 public:
+    // appends the moves of the given type to moves
+    template<GenType Type, Color c>
+    void generate(const Position& pos, MoveList& moves) {
+        assert(Type != EVASIONS || pos.checkers());
+
+        const Bitboard checkers = pos.checkers();
+
+        // in double check only the king can move
+        if (checkers & (checkers - 1)) {
+            generate_king_moves<Type, c>(pos, moves);
+            return;
+        }
+
+        const Bitboard checkMask = checkers
+            ? Attacks::between(pos.kingsq<c>(), getlsb(checkers)) | checkers
+            : ALL_SQUARES;
+
+        generate_pawn_moves<Type, c>(pos, moves, checkMask);
+        generate_knight_moves<Type, c>(pos, moves, checkMask);
+        generate_king_moves<Type, c>(pos, moves);
+        generate_sliding_moves<Type, c>(pos, moves, checkMask);
+        if constexpr (Type == QUIETS || Type == LEGAL) {
+            if (!checkers) generate_castling_moves<c>(pos, moves);
+        }
+    }
+
     template<Color c>
     void generate_all_moves(const Position& pos, MoveList& moves) {
         moves.clear();
-
-        generate_pawn_moves<c>(pos, moves);
-        generate_knight_moves<c>(pos, moves);
-        generate_king_moves<c>(pos, moves);
-        generate_sliding_moves<c>(pos, moves);
-        generate_castling_moves<c>(pos, moves);
+        generate<LEGAL, c>(pos, moves);
     }
 
 private:
 
+template <GenType Type>
+static constexpr bool genCaptures = Type == CAPTURES || Type == EVASIONS || Type == LEGAL;
+template <GenType Type>
+static constexpr bool genQuiets = Type != CAPTURES;
+
+// quiet moves of a pt on from that check the enemy king: onto a
+// checking square, or leaving the line of a discovered check
 template <Color c>
-void generate_knight_moves(const Position& pos,MoveList& moves){
-    //get our knight
-    Bitboard knights=pos.knights<c>();
+static Bitboard quiet_check_targets(const Position& pos, PieceType pt, Square from) {
+    Bitboard targets = pos.checkSquares(pt);
+    if (pos.discoverers() & bb(from))
+        targets |= ~Attacks::line(pos.kingsq<~c>(), from);
+    return targets;
+}
+
+// splits targets into capture and quiet moves of the requested type
+template <GenType Type, Color c>
+static void emit_piece_moves(const Position& pos, MoveList& moves, PieceType pt, Square from, Bitboard attacks) {
+    const Bitboard enemy = pos.occupancy(~c);
+
+    //generate captured move
+    if constexpr (genCaptures<Type>) {
+        Bitboard captures = attacks & enemy;
+        while (captures) {
+            moves.push_back(Move(from, poplsb(captures), Capture));
+        }
+    }
+    //generate quiet move
+    if constexpr (genQuiets<Type>) {
+        Bitboard quiets = attacks & ~enemy;
+        if constexpr (Type == QUIET_CHECKS) quiets &= quiet_check_targets<c>(pos, pt, from);
+        while (quiets) {
+            moves.push_back(Move(from, poplsb(quiets), QuietMove));
+        }
+    }
+}
+
+template <GenType Type, Color c>
+void generate_knight_moves(const Position& pos,MoveList& moves,Bitboard checkMask){
+    //get our knight, a pinned knight can never move
+    Bitboard knights=pos.knights<c>() & ~(pos.pinMaskHV() | pos.pinMaskD());
     //friendly piece
     Bitboard friendly=pos.occupancy(c);
-    //enemy pieces
-    Bitboard enemy=pos.occupancy(~c);
 
     while(knights){
         Square from=poplsb(knights);
@@ -38,54 +118,48 @@ void generate_knight_moves(const Position& pos,MoveList& moves){
         //get all square on which can attack
         Bitboard attacks=Attacks::get_knight_attacks(from);
         //remove square with friendly
-        attacks&=~friendly;
-        //split into quietmove and captue
-
-        Bitboard captures=attacks&enemy;
-        Bitboard quiets=attacks& ~enemy;
+        attacks&=~friendly & checkMask;
 
-        //generate captured move
-        while(captures){
-            Square to=poplsb(captures);
-            moves.push_back(Move(from,to,Capture));
-        }
-        //generate quiet move
-        while(quiets){
-            Square to=poplsb(quiets);
-            moves.push_back(Move(from,to,QuietMove));
-        }
+        emit_piece_moves<Type, c>(pos, moves, Knight, from, attacks);
     }
 }
 
-template <Color c>
-void generate_sliding_moves(const Position& pos,MoveList& moves){
+template <GenType Type, Color c>
+void generate_sliding_moves(const Position& pos,MoveList& moves,Bitboard checkMask){
     const Bitboard occupancy = pos.occupancy();
     const Bitboard friendly = pos.occupancy(c);
-    const Bitboard enemy = pos.occupancy(~c);
+    const Bitboard pinHV = pos.pinMaskHV();
+    const Bitboard pinD = pos.pinMaskD();
+
+    // a slider pinned along a line it moves on stays on the pin ray,
+    // pinned along the other kind of line it cannot move at all
+    auto slider_attacks = [&](Square from) {
+        switch (piecetype(pos.pieceAt(from))) {
+            case Bishop:
+                return Attacks::get_bishop_attacks(from, occupancy) & ((bb(from) & pinD) ? pinD : ALL_SQUARES);
+            case Rook:
+                return Attacks::get_rook_attacks(from, occupancy) & ((bb(from) & pinHV) ? pinHV : ALL_SQUARES);
+            default:
+                if (bb(from) & pinD) return Attacks::get_bishop_attacks(from, occupancy) & pinD;
+                if (bb(from) & pinHV) return Attacks::get_rook_attacks(from, occupancy) & pinHV;
+                return Attacks::get_queen_attacks(from, occupancy);
+        }
+    };
 
-    auto generate_for_slider = [&](Bitboard pieces, auto get_attacks_func) {
+    auto generate_for_slider = [&](Bitboard pieces) {
         while (pieces) {
             Square from = poplsb(pieces);
-            Bitboard attacks = get_attacks_func(from, occupancy) & ~friendly;
-
-            Bitboard captures = attacks & enemy;
-            while (captures) {
-                moves.push_back(Move(from, poplsb(captures), Capture));
-            }
-
-            Bitboard quiets = attacks & ~enemy;
-            while (quiets) {
-                moves.push_back(Move(from, poplsb(quiets), QuietMove));
-            }
+            Bitboard attacks = slider_attacks(from) & ~friendly & checkMask;
+            emit_piece_moves<Type, c>(pos, moves, piecetype(pos.pieceAt(from)), from, attacks);
         }
     };
 
-    generate_for_slider(pos.bishops<c>(), Attacks::get_bishop_attacks);
-    generate_for_slider(pos.rooks<c>(), Attacks::get_rook_attacks);
-    generate_for_slider(pos.queens<c>(), Attacks::get_queen_attacks);
+    generate_for_slider(pos.bishops<c>() & ~pinHV);
+    generate_for_slider(pos.rooks<c>() & ~pinD);
+    generate_for_slider(pos.queens<c>());
 }
 
-template <Color c>
+template <GenType Type, Color c>
 void generate_king_moves(const Position& pos, MoveList& moves){
         //get our knight
     Bitboard kings=pos.kings<c>();
@@ -106,15 +180,26 @@ void generate_king_moves(const Position& pos, MoveList& moves){
         Bitboard captures=attacks&enemy;
         Bitboard quiets=attacks& ~enemy;
 
+        // the king is taken off the board, it does not shield the square
+        // behind it from a slider that is checking it
+        const Bitboard occ=pos.occupancy()^bb(from);
+
+        //the king only ever gives a discovered check
+        if constexpr (Type == QUIET_CHECKS) {
+            quiets &= (pos.discoverers() & bb(from)) ? ~Attacks::line(pos.kingsq<~c>(), from) : EMPTY_BB;
+        }
+
         //generate captured move
-        while(captures){
+        while(genCaptures<Type> && captures){
             Square to=poplsb(captures);
-            moves.push_back(Move(from,to,Capture));
+            if(!pos.attackersTo<~c>(to,occ))
+                moves.push_back(Move(from,to,Capture));
         }
         //generate quiet move
-        while(quiets){
+        while(genQuiets<Type> && quiets){
             Square to=poplsb(quiets);
-            moves.push_back(Move(from,to,QuietMove));
+            if(!pos.attackersTo<~c>(to,occ))
+                moves.push_back(Move(from,to,QuietMove));
         }
     }
 }
@@ -160,9 +245,11 @@ void generate_castling_moves(const Position& pos,MoveList& moves){
     }
 }
 
-template <Color c>
-void generate_pawn_moves(const Position& pos,MoveList& moves){
+template <GenType Type, Color c>
+void generate_pawn_moves(const Position& pos,MoveList& moves,Bitboard checkMask){
     Bitboard pawns=pos.pawns<c>();
+    const Bitboard pinHV=pos.pinMaskHV();
+    const Bitboard pinD=pos.pinMaskD();
     Bitboard empty=~pos.occupancy();
     Bitboard enemy=pos.occupancy(~c);
 
@@ -175,28 +262,54 @@ void generate_pawn_moves(const Position& pos,MoveList& moves){
         int fromrank=from/8;
         Square to=Square(from+forward);
 
+        // pinned on a file a pawn may still push, pinned on a diagonal
+        // it may only capture the pinner, never both
+        Bitboard pushMask=checkMask;
+        Bitboard captureMask=checkMask;
+        if(bb(from)&pinHV){
+            pushMask&=pinHV;
+            captureMask=EMPTY_BB;
+        }
+        else if(bb(from)&pinD){
+            pushMask=EMPTY_BB;
+            captureMask&=pinD;
+        }
+
+        if constexpr (Type == QUIET_CHECKS) {
+            pushMask&=quiet_check_targets<c>(pos,Pawn,from);
+        }
+
         //single push
         if(empty&(1ULL<<to)){
-            if(fromrank==promotionrank){
-                moves.push_back(Move(from,to,QueenPromotion));
-                moves.push_back(Move(from,to,RookPromotion));
-                moves.push_back(Move(from,to,BishopPromotion));
-                moves.push_back(Move(from,to,KnightPromotion));
-            }
-            else {
-                moves.push_back(Move(from,to,QuietMove));
-                //double push
-                if(fromrank==doublepawnpush){
-                    Square to2=Square(from+2*forward);
-                    if((empty&(1ULL<<to2))&&(empty & (1ULL<<to))){
-                        moves.push_back(Move(from,to2,DoublePawnPush));
+            if(pushMask&bb(to)){
+                if(fromrank==promotionrank){
+                    // the queen promotion is searched with the captures
+                    if constexpr (Type != QUIETS && Type != QUIET_CHECKS)
+                        moves.push_back(Move(from,to,QueenPromotion));
+                    if constexpr (Type != CAPTURES && Type != QUIET_CHECKS) {
+                        moves.push_back(Move(from,to,RookPromotion));
+                        moves.push_back(Move(from,to,BishopPromotion));
+                        moves.push_back(Move(from,to,KnightPromotion));
                     }
                 }
+                else if constexpr (genQuiets<Type>) {
+                    moves.push_back(Move(from,to,QuietMove));
+                }
+            }
+
+            //double push, it may block a check the single push does not
+            if(genQuiets<Type> && fromrank==doublepawnpush){
+                Square to2=Square(from+2*forward);
+                if((empty&(1ULL<<to2))&&(pushMask&bb(to2))){
+                    moves.push_back(Move(from,to2,DoublePawnPush));
+                }
             }
         }
+
+        if constexpr (!genCaptures<Type>) continue;
         
         //captures
-        Bitboard attacks=Attacks::get_pawn_attacks(c,from) &enemy;
+        Bitboard attacks=Attacks::get_pawn_attacks(c,from) &enemy &captureMask;
         while(attacks){
             Square capSq=poplsb(attacks);
             if(fromrank==promotionrank){
@@ -215,7 +328,8 @@ void generate_pawn_moves(const Position& pos,MoveList& moves){
         if(epSq!=NO_SQ){
             Bitboard epAttack=Attacks::get_pawn_attacks(c,from) & (1ULL<<epSq);
             if(epAttack){
-                moves.push_back(Move(from,epSq,EnPassant));
+                Move ep(from,epSq,EnPassant);
+                if(pos.isLegal<c>(ep)) moves.push_back(ep);
             }
         }
         
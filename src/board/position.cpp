@@ -76,6 +76,36 @@ Position::Position(const std::string& FEN)
     parseFEN(FEN);
 }
 
+Position::Position(const Position& other) : state(nullptr), stateCount(0) {
+    *this = other;
+}
+
+Position& Position::operator=(const Position& other) {
+    if (this == &other) return *this;
+
+    std::copy(std::begin(other.PiecesBB), std::end(other.PiecesBB), std::begin(PiecesBB));
+    std::copy(std::begin(other.board), std::end(other.board), std::begin(board));
+    occupancyWhite = other.occupancyWhite;
+    occupancyBlack = other.occupancyBlack;
+    occupancyAll = other.occupancyAll;
+    stm = other.stm;
+    positionHistory = other.positionHistory;
+    fullMoveCounter = other.fullMoveCounter;
+    halfMoveCounter = other.halfMoveCounter;
+
+    // only the states in use are copied, links are rebased onto our stack
+    stateCount = other.stateCount;
+    for (uint16_t i = 0; i < stateCount; ++i) {
+        stateStack[i] = other.stateStack[i];
+        stateStack[i].previous = other.stateStack[i].previous
+            ? &stateStack[other.stateStack[i].previous - other.stateStack]
+            : nullptr;
+    }
+    state = &stateStack[other.state - other.stateStack];
+
+    return *this;
+}
+
 void Position::parseFEN(const std::string& FEN) {
     const auto& charToPiece = getCharToPiece();
 
@@ -92,6 +122,7 @@ void Position::parseFEN(const std::string& FEN) {
     state->hashKey = 0;
     state->captured = None;
     state->previous = nullptr;
+    state->dirty.clear();
     
     std::stringstream ss(FEN);
     std::string part;
@@ -161,6 +192,27 @@ void Position::parseFEN(const std::string& FEN) {
     
     // Generate hash
     state->hashKey = generateHashKey();
+
+    // makemove keeps these up to date from here on
+    state->psqScore = 0;
+    state->phase = 0;
+    state->pawnKey = 0;
+    for (Square sq = SQ_A1; sq <= SQ_H8; sq = Square(sq + 1)) {
+        Piece piece = pieceAt(sq);
+        if (piece == None) continue;
+        if (piecetype(piece) == Pawn) state->pawnKey ^= zobrist.pieceKeys[piece][sq];
+        state->psqScore += ASTROVE::eval::PieceSquareScore[piece][sq];
+        state->phase += ASTROVE::eval::PiecePhaseValue[piece];
+    }
+    state->materialKey = 0;
+    for (int piece = WhitePawn; piece <= BlackKing; ++piece) {
+        for (int n = 0; n < popcount(PiecesBB[piece]); ++n) {
+            state->materialKey ^= zobrist.pieceKeys[piece][n];
+        }
+    }
+
+    if (stm == White) updateCheckInfo<White>();
+    else updateCheckInfo<Black>();
 }
 
 std::string Position::toFEN() const {
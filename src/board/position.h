@@ -5,6 +5,8 @@
 #include "../core/attacks.h"
 #include "../core/bitboard.h"
 #include "../core/zobrist.h"
+#include "../evaluation/psqt.h"
+#include "../evaluation/nnue.h"
 #include <string>
 #include <vector>
 #include <cassert>
@@ -14,22 +16,36 @@ const std::string defaultFEN = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQ
 // State info for make/unmake
 struct StateInfo {
     uint64_t hashKey;
+    uint64_t pawnKey;       // pawns only, for the pawn hash table
+    uint64_t materialKey;   // piece counts only, for the material table
     Square enpassantSquare;
     U8 castlingRights;
     U8 halfMoveClock;
     Piece captured;
+
+    // incremental evaluation terms, updated by makemove
+    ASTROVE::EvalScore psqScore;    // material + psqt, white minus black
+    int phase;                      // game phase, not clamped
     
-    // masks for legal move generation
+    // masks for legal move generation, always for the side to move
     Bitboard checkers;      // Pieces giving check
-    Bitboard pinMaskHV;     // HV pinned pieces
-    Bitboard pinMaskD;      // Diagonal pinned pieces
+    Bitboard pinMaskHV;     // king (excl.) to HV pinner (incl.), every pin
+    Bitboard pinMaskD;      // same for diagonal pins
+
+    // to find checking moves of the side to move
+    Bitboard checkSquares[6];   // squares a piece type checks the enemy king from
+    Bitboard discoverers;       // own pieces blocking an own slider's line to it
+
+    // nnue: what makemove changed, the accumulators live in the evaluator
+    ASTROVE::nnue::DirtyPieces dirty;
     
     StateInfo* previous;
     
-    StateInfo() : hashKey(0), enpassantSquare(NO_SQ), 
+    StateInfo() : hashKey(0), pawnKey(0), materialKey(0), enpassantSquare(NO_SQ), 
                   castlingRights(NO_CASTLING), halfMoveClock(0),
-                  captured(None), checkers(EMPTY_BB), 
+                  captured(None), psqScore(0), phase(0), checkers(EMPTY_BB), 
                   pinMaskHV(EMPTY_BB), pinMaskD(EMPTY_BB),
+                  checkSquares{}, discoverers(EMPTY_BB),
                   previous(nullptr) {}
 };
 
@@ -39,6 +55,9 @@ public:
 
     // constructor
     Position(const std::string& FEN = defaultFEN);
+    // copies rebase the state pointers into the new object's stateStack
+    Position(const Position& other);
+    Position& operator=(const Position& other);
     void parseFEN(const std::string& FEN);
     std::string toFEN() const;
     void print();
@@ -51,13 +70,36 @@ public:
     inline Piece pieceAt(Square sq) const { return board[sq]; }
     inline Color sideToMove() const { return stm; }
     inline uint64_t hash() const { return state->hashKey; }
+    inline uint64_t pawnKey() const { return state->pawnKey; }
+    inline uint64_t materialKey() const { return state->materialKey; }
     inline Square epSquare() const { return state->enpassantSquare; }
     inline U8 castling() const { return state->castlingRights; }
+    inline ASTROVE::EvalScore psqScore() const { return state->psqScore; }
+    inline int gamePhase() const { return state->phase; }
+    // the nnue update walks the moves back from here, the accumulator of a
+    // state has the state's index in the evaluator
+    inline const StateInfo* stateInfo() const { return state; }
+    inline int stateIndex() const { return int(state - stateStack); }
 
     // Attack queries
     template <Color c> inline bool isSquareAttacked(Square sq) const;
     template <Color c> Square kingsq() const;
     template <Color c> bool inCheck() const;
+    // pieces of color c attacking sq, with a custom occupancy
+    template <Color c> Bitboard attackersTo(Square sq, Bitboard occ) const;
+
+    inline Bitboard checkers() const { return state->checkers; }
+    inline Bitboard pinMaskHV() const { return state->pinMaskHV; }
+    inline Bitboard pinMaskD() const { return state->pinMaskD; }
+    inline Bitboard checkSquares(PieceType pt) const { return state->checkSquares[pt]; }
+    inline Bitboard discoverers() const { return state->discoverers; }
+
+    // move validation for moves not produced by the generator (tt, killers)
+    template <Color c> bool isPseudoLegal(Move move) const;
+    // a pseudo legal move is legal if it does not leave our king in check
+    template <Color c> bool isLegal(Move move) const;
+    // true if the legal move checks the enemy king, c is the side to move
+    template <Color c> bool givesCheck(Move move) const;
     
     // Bitboard getters
     template <Color c> constexpr Bitboard pawns()   const { return (c == White) ? PiecesBB[WhitePawn]   : PiecesBB[BlackPawn]; }
@@ -97,7 +139,7 @@ public:
 
     //unmake null move
     template <Color c>
-    inline void unmakeNullMove(Square sq,uint8_t halfMove,uint16_t fullMove);
+    inline void unmakeNullMove();
 
     // getter for NMP
     inline uint8_t getHalfMoveClock() const { return state->halfMoveClock; }
@@ -125,10 +167,35 @@ private:
     uint16_t fullMoveCounter;
     uint16_t halfMoveCounter;
 
+    // checkers, pin masks and check squares of side c (to move) into state
+    template <Color c> void updateCheckInfo();
+
     // Helper functions
     void placePiece(Piece piece, Square sq);
     void removePiece(Square sq);
     void movePiece(Square from, Square to);
+
+    // makemove helpers: board, hash and incremental eval together,
+    // unmakemove only restores the board, the state is popped
+    inline void addPiece(Piece piece, Square sq) {
+        togglePiece(piece, sq);
+        placePiece(piece, sq);
+        state->psqScore += ASTROVE::eval::PieceSquareScore[piece][sq];
+        state->phase += ASTROVE::eval::PiecePhaseValue[piece];
+        state->dirty.push(piece, sq, true);
+        if (piecetype(piece) == Pawn) state->pawnKey ^= zobrist.pieceKeys[piece][sq];
+        // the n-th piece of a kind toggles key [piece][n - 1]
+        state->materialKey ^= zobrist.pieceKeys[piece][popcount(PiecesBB[piece]) - 1];
+    }
+    inline void clearPiece(Piece piece, Square sq) {
+        togglePiece(piece, sq);
+        removePiece(sq);
+        state->psqScore -= ASTROVE::eval::PieceSquareScore[piece][sq];
+        state->phase -= ASTROVE::eval::PiecePhaseValue[piece];
+        state->dirty.push(piece, sq, false);
+        if (piecetype(piece) == Pawn) state->pawnKey ^= zobrist.pieceKeys[piece][sq];
+        state->materialKey ^= zobrist.pieceKeys[piece][popcount(PiecesBB[piece])];
+    }
     
     // Zobrist helpers (inline for speed)
     inline void togglePiece(Piece piece, Square sq) {
@@ -199,6 +266,223 @@ Square Position::kingsq() const {
     return bsf(kings<Black>());
 }
 
+template <Color c>
+inline Bitboard Position::attackersTo(Square sq, Bitboard occ) const {
+    return (Attacks::get_pawn_attacks(~c, sq) & pawns<c>())
+         | (Attacks::get_knight_attacks(sq) & knights<c>())
+         | (Attacks::get_king_attacks(sq) & kings<c>())
+         | (Attacks::get_bishop_attacks(sq, occ) & (bishops<c>() | queens<c>()))
+         | (Attacks::get_rook_attacks(sq, occ) & (rooks<c>() | queens<c>()));
+}
+
+// a slider of the enemy with exactly one of our pieces between it and our
+// king pins that piece, the pin mask gets the ray including the pinner
+template <Color c>
+inline void Position::updateCheckInfo() {
+    const Square ksq = kingsq<c>();
+    const Bitboard own = occupancy(c);
+
+    state->checkers = attackersTo<~c>(ksq, occupancyAll);
+    state->pinMaskHV = EMPTY_BB;
+    state->pinMaskD = EMPTY_BB;
+
+    Bitboard snipers = Attacks::get_rook_attacks(ksq, occupancy(~c)) & (rooks<~c>() | queens<~c>());
+    while (snipers) {
+        Square s = poplsb(snipers);
+        Bitboard ray = Attacks::between(ksq, s);
+        if (popcount(ray & occupancyAll) == 1 && (ray & own))
+            state->pinMaskHV |= ray | bb(s);
+    }
+
+    snipers = Attacks::get_bishop_attacks(ksq, occupancy(~c)) & (bishops<~c>() | queens<~c>());
+    while (snipers) {
+        Square s = poplsb(snipers);
+        Bitboard ray = Attacks::between(ksq, s);
+        if (popcount(ray & occupancyAll) == 1 && (ray & own))
+            state->pinMaskD |= ray | bb(s);
+    }
+
+    // the same seen from the enemy king: where our pieces would check it,
+    // and which of our pieces uncover a check when they step aside
+    const Square theirKsq = kingsq<~c>();
+    state->checkSquares[Pawn]   = Attacks::get_pawn_attacks(~c, theirKsq);
+    state->checkSquares[Knight] = Attacks::get_knight_attacks(theirKsq);
+    state->checkSquares[Bishop] = Attacks::get_bishop_attacks(theirKsq, occupancyAll);
+    state->checkSquares[Rook]   = Attacks::get_rook_attacks(theirKsq, occupancyAll);
+    state->checkSquares[Queen]  = state->checkSquares[Bishop] | state->checkSquares[Rook];
+    state->checkSquares[King]   = EMPTY_BB;
+
+    state->discoverers = EMPTY_BB;
+    snipers = (Attacks::get_rook_attacks(theirKsq, occupancy(~c)) & (rooks<c>() | queens<c>()))
+            | (Attacks::get_bishop_attacks(theirKsq, occupancy(~c)) & (bishops<c>() | queens<c>()));
+    while (snipers) {
+        Square s = poplsb(snipers);
+        Bitboard blockers = Attacks::between(theirKsq, s) & occupancyAll;
+        if (popcount(blockers) == 1 && (blockers & own))
+            state->discoverers |= blockers;
+    }
+}
+
+// true if move could have been produced by MoveGenerator in this position
+// (same pseudo legal rules, legality w.r.t. own king is not checked)
+template <Color c>
+bool Position::isPseudoLegal(Move move) const {
+    if (!move.is_valid()) return false;
+
+    const Square from = move.from();
+    const Square to = move.to();
+    const MoveFlag flag = move.flag();
+    const Piece piece = board[from];
+    const Piece target = board[to];
+
+    if (piece == None || piececolor(piece) != c || from == to) return false;
+    if (flag == 6 || flag == 7) return false; // unused flag values
+
+    const PieceType pt = piecetype(piece);
+
+    // castling, same conditions as generate_castling_moves
+    if (flag == KingCastle || flag == QueenCastle) {
+        constexpr Square kingFrom = (c == White) ? SQ_E1 : SQ_E8;
+        if (pt != King || from != kingFrom) return false;
+
+        if (flag == KingCastle) {
+            constexpr U8 right = (c == White) ? WHITE_OO : BLACK_OO;
+            return (castling() & right) && to == kingFrom + 2
+                && board[kingFrom + 1] == None && board[kingFrom + 2] == None
+                && !isSquareAttacked<~c>(kingFrom)
+                && !isSquareAttacked<~c>(kingFrom + 1)
+                && !isSquareAttacked<~c>(kingFrom + 2);
+        }
+        constexpr U8 right = (c == White) ? WHITE_OOO : BLACK_OOO;
+        return (castling() & right) && to == kingFrom - 2
+            && board[kingFrom - 1] == None && board[kingFrom - 2] == None
+            && board[kingFrom - 3] == None
+            && !isSquareAttacked<~c>(kingFrom)
+            && !isSquareAttacked<~c>(kingFrom - 1)
+            && !isSquareAttacked<~c>(kingFrom - 2);
+    }
+
+    if (flag == EnPassant) {
+        return pt == Pawn && to == epSquare()
+            && (Attacks::get_pawn_attacks(c, from) & bb(to));
+    }
+
+    // capture flags need an enemy piece on target, quiet flags an empty square
+    if (move.is_capture()) {
+        if (target == None || piececolor(target) == c || piecetype(target) == King)
+            return false;
+    }
+    else if (target != None) {
+        return false;
+    }
+
+    if (pt == Pawn) {
+        constexpr int forward = (c == White) ? 8 : -8;
+        constexpr Rank lastRank = (c == White) ? RANK_8 : RANK_1;
+        constexpr Rank startRank = (c == White) ? RANK_2 : RANK_7;
+
+        if (move.is_promotion() != (rankof(to) == lastRank)) return false;
+
+        if (move.is_capture())
+            return Attacks::get_pawn_attacks(c, from) & bb(to);
+        if (flag == DoublePawnPush)
+            return rankof(from) == startRank && to == from + 2 * forward
+                && board[from + forward] == None;
+        return to == from + forward;
+    }
+
+    if (flag != QuietMove && flag != Capture) return false;
+
+    Bitboard attacks;
+    switch (pt) {
+        case Knight: attacks = Attacks::get_knight_attacks(from); break;
+        case Bishop: attacks = Attacks::get_bishop_attacks(from, occupancyAll); break;
+        case Rook:   attacks = Attacks::get_rook_attacks(from, occupancyAll); break;
+        case Queen:  attacks = Attacks::get_queen_attacks(from, occupancyAll); break;
+        default:     attacks = Attacks::get_king_attacks(from); break;
+    }
+    return attacks & bb(to);
+}
+
+// move must be pseudo legal and c the side to move
+template <Color c>
+bool Position::isLegal(Move move) const {
+    const Square from = move.from();
+    const Square to = move.to();
+    const Square ksq = kingsq<c>();
+
+    // the captured pawn leaves its square too, look at the board as it
+    // will be after the capture
+    if (move.flag() == EnPassant) {
+        const Square capSq = Square(to + ((c == White) ? -8 : 8));
+        const Bitboard occ = (occupancyAll ^ bb(from) ^ bb(capSq)) | bb(to);
+        return !(attackersTo<~c>(ksq, occ) & ~bb(capSq));
+    }
+
+    // castling squares were checked by isPseudoLegal, a king must not step
+    // onto an attacked square (it no longer blocks a slider behind it)
+    if (from == ksq) {
+        if (move.flag() == KingCastle || move.flag() == QueenCastle) return true;
+        return !attackersTo<~c>(to, occupancyAll ^ bb(from));
+    }
+
+    // in check: capture the checker or block it, never possible vs two
+    const Bitboard checking = state->checkers;
+    if (checking) {
+        if (checking & (checking - 1)) return false;
+        if (!((Attacks::between(ksq, getlsb(checking)) | checking) & bb(to))) return false;
+    }
+
+    // a pinned piece may only move along its pin
+    const Bitboard pinned = (state->pinMaskHV | state->pinMaskD) & occupancy(c);
+    return !(pinned & bb(from)) || (Attacks::line(ksq, from) & bb(to));
+}
+
+template <Color c>
+bool Position::givesCheck(Move move) const {
+    const Square from = move.from();
+    const Square to = move.to();
+    const MoveFlag flag = move.flag();
+    const Square theirKsq = kingsq<~c>();
+
+    // direct check, a promoted piece attacks through the square it left
+    if (move.is_promotion()) {
+        const Bitboard occ = occupancyAll ^ bb(from);
+        Bitboard attacks;
+        switch (move.promoted_piece_type()) {
+            case Knight: attacks = Attacks::get_knight_attacks(to); break;
+            case Bishop: attacks = Attacks::get_bishop_attacks(to, occ); break;
+            case Rook:   attacks = Attacks::get_rook_attacks(to, occ); break;
+            default:     attacks = Attacks::get_queen_attacks(to, occ); break;
+        }
+        if (attacks & bb(theirKsq)) return true;
+    }
+    else if (state->checkSquares[piecetype(board[from])] & bb(to)) {
+        return true;
+    }
+
+    // discovered check
+    if ((state->discoverers & bb(from)) && !(Attacks::line(theirKsq, from) & bb(to)))
+        return true;
+
+    // en passant also removes the captured pawn from a line to the king
+    if (flag == EnPassant) {
+        const Square capSq = Square(to + ((c == White) ? -8 : 8));
+        const Bitboard occ = (occupancyAll ^ bb(from) ^ bb(capSq)) | bb(to);
+        return (Attacks::get_rook_attacks(theirKsq, occ) & (rooks<c>() | queens<c>()))
+             | (Attacks::get_bishop_attacks(theirKsq, occ) & (bishops<c>() | queens<c>()));
+    }
+
+    // castling checks with the rook
+    if (flag == KingCastle || flag == QueenCastle) {
+        const Square rookFrom = (flag == KingCastle) ? Square(from + 3) : Square(from - 4);
+        const Square rookTo   = (flag == KingCastle) ? Square(from + 1) : Square(from - 1);
+        const Bitboard occ = (occupancyAll ^ bb(from) ^ bb(rookFrom)) | bb(to) | bb(rookTo);
+        return Attacks::get_rook_attacks(rookTo, occ) & bb(theirKsq);
+    }
+    return false;
+}
+
 template <Color c>
 void Position::makemove(Move move){
     Square from=move.from();
@@ -216,10 +500,15 @@ void Position::makemove(Move move){
 
     //copy current state values
     newState->hashKey=state->hashKey;
+    newState->pawnKey=state->pawnKey;
+    newState->materialKey=state->materialKey;
     newState->castlingRights=state->castlingRights;
     newState->enpassantSquare=state->enpassantSquare;
     newState->halfMoveClock=state->halfMoveClock;
     newState->captured=capturedPiece;
+    newState->psqScore=state->psqScore;
+    newState->phase=state->phase;
+    newState->dirty.clear();
 
     state=newState;
 
@@ -237,8 +526,7 @@ void Position::makemove(Move move){
     //4. HANDLE CAPTURES(NORMAL)
     if(move.is_capture()&&flag!=EnPassant){
         state->halfMoveClock=0;
-        togglePiece(capturedPiece,to);
-        removePiece(to);
+        clearPiece(capturedPiece,to);
     }
     
     // 5.HANDLE ENPASSANT CAPTURE
@@ -248,8 +536,7 @@ void Position::makemove(Move move){
         Square capSq=Square(to+offset);
         Piece epPawn=makepiece<~c>(Pawn);
 
-        togglePiece(epPawn,capSq);
-        removePiece(capSq);
+        clearPiece(epPawn,capSq);
     }
 
     // 6. HANDLE DOUBLE PAWN PUSH
@@ -274,31 +561,23 @@ void Position::makemove(Move move){
     if(flag==KingCastle){
         if constexpr (c==White){
             //move king
-            togglePiece(WhiteKing,from);
-            removePiece(from);
-            togglePiece(WhiteKing,to);
-            placePiece(WhiteKing,to);
+            clearPiece(WhiteKing,from);
+            addPiece(WhiteKing,to);
 
             //move rook
-            togglePiece(WhiteRook,SQ_H1);
-            removePiece(SQ_H1);
-            togglePiece(WhiteRook,SQ_F1);
-            placePiece(WhiteRook,SQ_F1);
+            clearPiece(WhiteRook,SQ_H1);
+            addPiece(WhiteRook,SQ_F1);
 
             state->castlingRights &= ~(WHITE_OO|WHITE_OOO);
         }
         else {
             //move king
-            togglePiece(BlackKing,from);
-            removePiece(from);
-            togglePiece(BlackKing,to);
-            placePiece(BlackKing,to);
+            clearPiece(BlackKing,from);
+            addPiece(BlackKing,to);
 
             //move rook
-            togglePiece(BlackRook,SQ_H8);
-            removePiece(SQ_H8);
-            togglePiece(BlackRook,SQ_F8);
-            placePiece(BlackRook,SQ_F8);
+            clearPiece(BlackRook,SQ_H8);
+            addPiece(BlackRook,SQ_F8);
 
             state->castlingRights &= ~(BLACK_OO|BLACK_OOO);
         }
@@ -306,31 +585,23 @@ void Position::makemove(Move move){
     else if(flag==QueenCastle){
         if constexpr (c==White){
             //move king
-            togglePiece(WhiteKing,from);
-            removePiece(from);
-            togglePiece(WhiteKing,to);
-            placePiece(WhiteKing,to);
+            clearPiece(WhiteKing,from);
+            addPiece(WhiteKing,to);
 
             //move rook
-            togglePiece(WhiteRook,SQ_A1);
-            removePiece(SQ_A1);
-            togglePiece(WhiteRook,SQ_D1);
-            placePiece(WhiteRook,SQ_D1);
+            clearPiece(WhiteRook,SQ_A1);
+            addPiece(WhiteRook,SQ_D1);
 
             state->castlingRights &= ~(WHITE_OO|WHITE_OOO);
         }
         else {
             //move king
-            togglePiece(BlackKing,from);
-            removePiece(from);
-            togglePiece(BlackKing,to);
-            placePiece(BlackKing,to);
+            clearPiece(BlackKing,from);
+            addPiece(BlackKing,to);
 
             //move rook
-            togglePiece(BlackRook,SQ_A8);
-            removePiece(SQ_A8);
-            togglePiece(BlackRook,SQ_D8);
-            placePiece(BlackRook,SQ_D8);
+            clearPiece(BlackRook,SQ_A8);
+            addPiece(BlackRook,SQ_D8);
 
             state->castlingRights &= ~(BLACK_OO|BLACK_OOO);
         }
@@ -339,12 +610,7 @@ void Position::makemove(Move move){
     // 9. HANDLE PROMOTION
     else if(move.is_promotion()){
         state->halfMoveClock=0;
-
-        if (move.is_capture()) {
-            // capturedPiece is already set at the top of the function
-            togglePiece(capturedPiece, to);
-            removePiece(to);
-        }
+        // a captured piece was already removed in step 4
 
         Piece promotedPiece;
         switch(flag){
@@ -366,12 +632,10 @@ void Position::makemove(Move move){
         }
         //remove pawn from source
         Piece pawn=makepiece<c>(Pawn);
-        togglePiece(pawn,from);
-        removePiece(from);
+        clearPiece(pawn,from);
 
         //place promoted piece
-        togglePiece(promotedPiece,to);
-        placePiece(promotedPiece,to);
+        addPiece(promotedPiece,to);
     }
     // 10. NORMAL MOVE
     else if(flag!=KingCastle && flag!=QueenCastle){
@@ -381,10 +645,8 @@ void Position::makemove(Move move){
         }
 
         //move the piece
-        togglePiece(movingpiece,from);
-        removePiece(from);
-        togglePiece(movingpiece,to);
-        placePiece(movingpiece,to);
+        clearPiece(movingpiece,from);
+        addPiece(movingpiece,to);
     }
 
     // 11. UPDATE CASTLE RIGHT(IF ROOK OR KING MOVED)
@@ -426,6 +688,7 @@ void Position::makemove(Move move){
     // 13. SWITCH SIDE TO MOVE
     stm = ~stm;
     toggleSide();
+    updateCheckInfo<~c>();
     
     // 14. INCREMENT FULLMOVE
     if (stm == White) {
@@ -546,6 +809,16 @@ inline bool Position::isDrawByFiftyMove() const {
 
 template <Color c>
 inline void Position::makeNullMove(){
+        // a null move gets its own state, unmaking it is a pop
+        assert(stateCount < 1024);
+        StateInfo* newState = &stateStack[stateCount++];
+        *newState = *state;
+        newState->previous = state;
+        newState->captured = None;
+        // same pieces, the accumulator is copied from the previous state
+        newState->dirty.clear();
+        state = newState;
+
         if(state->enpassantSquare!=NO_SQ){
             toggleEnpassant(state->enpassantSquare);
         }
@@ -560,28 +833,20 @@ inline void Position::makeNullMove(){
         //switch side to move and toggle in hash
         stm=~c;
         toggleSide();
+        updateCheckInfo<~c>();
 
         positionHistory.push_back(hash());
 }
 
 template <Color c>
-inline void Position::unmakeNullMove(Square ep,uint8_t halfMove,uint16_t fullmove){
-    if(!positionHistory.empty()){
-        positionHistory.pop_back();
-    }
+inline void Position::unmakeNullMove(){
+    positionHistory.pop_back();
 
     stm=c;
-    toggleSide();
-
     if(c==Black){
-        fullMoveCounter=fullmove;
+        fullMoveCounter--;
     }
 
-    state->halfMoveClock=halfMove;
-
-    state->enpassantSquare=ep;
-
-    if(ep!=NO_SQ){
-        toggleEnpassant(ep);
-    }
+    state = state->previous;
+    stateCount--;
 }
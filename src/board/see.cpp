@@ -0,0 +1,116 @@
+#include "see.h"
+#include "../core/attacks.h"
+
+namespace {
+
+    // pieces of side c pinned to their king by an enemy slider, the
+    // position only keeps them for the side to move
+    Bitboard pinnedPieces(const Position& pos, Color c) {
+        if (c == pos.sideToMove()) {
+            return (pos.pinMaskHV() | pos.pinMaskD()) & pos.occupancy(c);
+        }
+
+        const Square ksq = (c == White) ? pos.kingsq<White>() : pos.kingsq<Black>();
+        const Bitboard occ = pos.occupancy();
+        const Bitboard own = pos.occupancy(c);
+        const Bitboard enemy = pos.occupancy(~c);
+        const Bitboard queens = pos.pieces(~c, Queen);
+
+        Bitboard snipers = (Attacks::get_rook_attacks(ksq, enemy) & (pos.pieces(~c, Rook) | queens))
+                         | (Attacks::get_bishop_attacks(ksq, enemy) & (pos.pieces(~c, Bishop) | queens));
+        Bitboard pinned = EMPTY_BB;
+        while (snipers) {
+            Bitboard ray = Attacks::between(ksq, poplsb(snipers)) & occ;
+            if (popcount(ray) == 1) pinned |= ray & own;
+        }
+        return pinned;
+    }
+
+} // namespace
+
+bool see_ge(const Position& pos, Move move, int threshold) {
+    const MoveFlag flag = move.flag();
+    // the king and rook land on unattacked squares
+    if (flag == KingCastle || flag == QueenCastle) return threshold <= 0;
+
+    const Square from = move.from();
+    const Square to = move.to();
+    const Color us = piececolor(pos.pieceAt(from));
+
+    PieceType captured = (flag == EnPassant) ? Pawn : piecetype(pos.pieceAt(to));
+    PieceType onSquare = move.is_promotion() ? move.promoted_piece_type() : piecetype(pos.pieceAt(from));
+
+    // what the move wins if nothing recaptures
+    int swap = SEE_VALUE[captured] - threshold;
+    if (move.is_promotion()) swap += SEE_VALUE[onSquare] - SEE_VALUE[Pawn];
+    if (swap < 0) return false;
+
+    // what is left if the piece on the square is lost for nothing
+    swap = SEE_VALUE[onSquare] - swap;
+    if (swap <= 0) return true;
+
+    Bitboard occ = pos.occupancy() ^ bb(from) ^ bb(to);
+    if (flag == EnPassant) occ ^= bb(Square(us == White ? to - 8 : to + 8));
+
+    const Bitboard bishopsQueens = pos.pieces(White, Bishop) | pos.pieces(Black, Bishop)
+                                 | pos.pieces(White, Queen) | pos.pieces(Black, Queen);
+    const Bitboard rooksQueens = pos.pieces(White, Rook) | pos.pieces(Black, Rook)
+                               | pos.pieces(White, Queen) | pos.pieces(Black, Queen);
+
+    Bitboard attackers = (pos.attackersTo<White>(to, occ) | pos.attackersTo<Black>(to, occ)) & occ;
+
+    // a pinned piece only recaptures when to lies on its pin ray
+    Bitboard pinned[2] = { EMPTY_BB, EMPTY_BB };
+    bool pinsKnown[2] = { false, false };
+
+    Color stm = us;
+    bool res = true;     // does the side that moved first reach the threshold
+
+    while (true) {
+        stm = ~stm;
+        attackers &= occ;
+
+        Bitboard stmAttackers = attackers & pos.occupancy(stm);
+        if (!stmAttackers) break;
+
+        if (!pinsKnown[stm]) {
+            pinned[stm] = pinnedPieces(pos, stm);
+            pinsKnown[stm] = true;
+        }
+        Bitboard stuck = stmAttackers & pinned[stm];
+        if (stuck) {
+            const Square ksq = (stm == White) ? pos.kingsq<White>() : pos.kingsq<Black>();
+            while (stuck) {
+                Square s = poplsb(stuck);
+                if (!(Attacks::line(ksq, s) & bb(to))) stmAttackers ^= bb(s);
+            }
+            if (!stmAttackers) break;
+        }
+
+        res = !res;
+
+        // least valuable attacker, its capture has to keep the balance
+        PieceType pt = Pawn;
+        Bitboard b = EMPTY_BB;
+        for (; pt <= King; pt = PieceType(pt + 1)) {
+            if ((b = stmAttackers & pos.pieces(stm, pt))) break;
+        }
+
+        if (pt == King) {
+            // the king can not take into a defended square
+            return (attackers & pos.occupancy(~stm)) ? !res : res;
+        }
+
+        if ((swap = SEE_VALUE[pt] - swap) < int(res)) break;
+
+        occ ^= b & -b;
+
+        // sliders lined up behind the capturer join in
+        if (pt == Pawn || pt == Bishop || pt == Queen)
+            attackers |= Attacks::get_bishop_attacks(to, occ) & bishopsQueens;
+        if (pt == Rook || pt == Queen)
+            attackers |= Attacks::get_rook_attacks(to, occ) & rooksQueens;
+    }
+
+    return res;
+}
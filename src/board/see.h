@@ -0,0 +1,24 @@
+#pragma once
+#include "../core/types.h"
+#include "../core/move.h"
+#include "position.h"
+
+// ==================== STATIC EXCHANGE EVALUATION ===========================
+// see_ge(pos, move, threshold) answers whether the exchange started by move
+// on its target square gains at least threshold, both sides recapturing
+// with their least valuable attacker and free to stop at any point.
+//
+// It never builds the full gain list: the running balance is compared
+// against the threshold after every capture and the loop stops as soon
+// as the side to recapture can not change the answer.
+//  - sliders behind a capturer join the exchange (x-rays)
+//  - a pinned piece only recaptures along its pin ray, the side to move's
+//    pins come from the position, the other side's are found on demand
+//  - en passant takes the pawn behind the target square, a promotion puts
+//    the promoted piece on the square
+//  - the king only recaptures when the square is no longer defended
+// ============================================================================
+
+constexpr int SEE_VALUE[7] = { 100, 300, 300, 500, 900, 0, 0 };  // by PieceType
+
+bool see_ge(const Position& pos, Move move, int threshold);
@@ -5,6 +5,47 @@
 // This namespace will hold all our attack generation logic.
 namespace Attacks {
 
+    // BETWEEN[a][b]: squares strictly between a and b, LINE[a][b]: the whole
+    // line through both, edge to edge. Both are empty if a and b do not share
+    // a rank, file or diagonal. Built at compile time, no init() needed.
+    struct LineTables {
+        Bitboard between[64][64];
+        Bitboard line[64][64];
+    };
+
+    constexpr LineTables buildLineTables() {
+        LineTables t{};
+        constexpr int df[8] = { 1, -1, 0,  0, 1, -1,  1, -1 };
+        constexpr int dr[8] = { 0,  0, 1, -1, 1, -1, -1,  1 };
+
+        for (int a = 0; a < 64; ++a) {
+            // directions come in opposite pairs (0,1) (2,3) (4,5) (6,7)
+            for (int d = 0; d < 8; d += 2) {
+                Bitboard full = 1ULL << a;
+                for (int k = d; k <= d + 1; ++k) {
+                    for (int f = a % 8 + df[k], r = a / 8 + dr[k];
+                         f >= 0 && f < 8 && r >= 0 && r < 8; f += df[k], r += dr[k])
+                        full |= 1ULL << (r * 8 + f);
+                }
+                for (int k = d; k <= d + 1; ++k) {
+                    Bitboard ray = 0;
+                    for (int f = a % 8 + df[k], r = a / 8 + dr[k];
+                         f >= 0 && f < 8 && r >= 0 && r < 8; f += df[k], r += dr[k]) {
+                        t.between[a][r * 8 + f] = ray;
+                        t.line[a][r * 8 + f] = full;
+                        ray |= 1ULL << (r * 8 + f);
+                    }
+                }
+            }
+        }
+        return t;
+    }
+
+    inline constexpr LineTables LINE_TABLES = buildLineTables();
+
+    constexpr Bitboard between(Square a, Square b) { return LINE_TABLES.between[a][b]; }
+    constexpr Bitboard line(Square a, Square b) { return LINE_TABLES.line[a][b]; }
+
     // Pre-calculated attack tables
     extern const Bitboard PAWN_ATTACKS[2][64];
     extern const Bitboard KNIGHT_ATTACKS[64];
@@ -2,6 +2,7 @@
 #include "types.h" // For squareToString
 
 const Move NO_MOVE = Move();
+const Move NULL_MOVE = Move(MoveData(65));
 
 Move::Move(Square from, Square to, MoveFlag flag) {
     m_data = (static_cast<MoveData>(flag) << 12) | 
@@ -2,7 +2,6 @@
 
 #include "types.h"
 #include <string>
-#include <vector>
 
 // Bits 0-5:   'from' square
 // Bits 6-11:  'to' square
@@ -41,6 +40,9 @@ public:
     constexpr Square to() const { return Square((m_data >> 6) & 0x3f); }
     constexpr MoveFlag flag() const { return MoveFlag((m_data >> 12) & 0xf); }
     bool is_valid() const { return m_data != 0; }
+    constexpr MoveData raw() const { return m_data; }
+    constexpr bool operator==(const Move& other) const { return m_data == other.m_data; }
+    constexpr bool operator!=(const Move& other) const { return m_data != other.m_data; }
     // Helpers
     constexpr bool is_capture() const { return (flag() &0x4)!=0; }
     constexpr bool is_promotion() const { return (flag() >= KnightPromotion); }
@@ -75,7 +77,44 @@ private:
 };
 
 extern const Move NO_MOVE;
+// marks a null move on the search stack, from == to so it is never generated
+extern const Move NULL_MOVE;
 
-// A list of move
-using MoveList = std::vector<Move>;
+// no legal chess position has more moves than this
+constexpr int MAX_MOVES = 256;
+
+// a move plus the score the move picker orders it by
+struct ExtMove : public Move {
+    int score;
+
+    ExtMove() = default;
+    ExtMove(Move move, int score = 0) : Move(move), score(score) {}
+    ExtMove& operator=(Move move) { Move::operator=(move); return *this; }
+};
+
+// A list of move, fixed capacity and kept on the stack so generating
+// moves never touches the heap
+class MoveList {
+public:
+    MoveList() : count(0) {}
+
+    void push_back(Move move) { moves[count++] = move; }
+    void clear() { count = 0; }
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    ExtMove& operator[](size_t i) { return moves[i]; }
+    const ExtMove& operator[](size_t i) const { return moves[i]; }
+
+    ExtMove* begin() { return moves; }
+    ExtMove* end() { return moves + count; }
+    const ExtMove* begin() const { return moves; }
+    const ExtMove* end() const { return moves + count; }
+
+private:
+    // left uninitialized, only [0, count) is ever read
+    union { ExtMove moves[MAX_MOVES]; };
+    size_t count;
+};
 
@@ -0,0 +1,46 @@
+#include "endgame.h"
+#include "../evaluation/evaluation.h"
+#include <algorithm>
+
+namespace ASTROVE::eval {
+
+    // a forced mate is worth more than any material count, still far from mate scores
+    constexpr int KnownWinBonus = 1000;
+    constexpr Bitboard LightSquares = 0x55AA55AA55AA55AAULL;
+
+    // 0 on the four centre squares up to 6 in a corner
+    inline int centre_distance(Square sq) {
+        int f = fileof(sq), r = rankof(sq);
+        return std::max(3 - f, f - 4) + std::max(3 - r, r - 4);
+    }
+
+    template <Color strong>
+    int evaluate_KXK(const Position& pos) {
+        constexpr Color weak = ~strong;
+        const Square strongKing = pos.kingsq<strong>();
+        const Square weakKing = pos.kingsq<weak>();
+
+        int result = popcount(pos.pawns<strong>())   * endgameScore(PieceValues[Pawn])
+                   + popcount(pos.knights<strong>()) * endgameScore(PieceValues[Knight])
+                   + popcount(pos.bishops<strong>()) * endgameScore(PieceValues[Bishop])
+                   + popcount(pos.rooks<strong>())   * endgameScore(PieceValues[Rook])
+                   + popcount(pos.queens<strong>())  * endgameScore(PieceValues[Queen]);
+
+        // mate happens on the edge, with our king close by
+        result += 20 * centre_distance(weakKing);
+        result += 10 * (7 - squareDistance(strongKing, weakKing));
+
+        const Bitboard bishops = pos.bishops<strong>();
+        if (pos.queens<strong>() || pos.rooks<strong>()
+            || (bishops && pos.knights<strong>())
+            || ((bishops & LightSquares) && (bishops & ~LightSquares))) {
+            result += KnownWinBonus;
+        }
+
+        return pos.sideToMove() == strong ? result : -result;
+    }
+
+    template int evaluate_KXK<White>(const Position& pos);
+    template int evaluate_KXK<Black>(const Position& pos);
+
+} // namespace ASTROVE::eval
@@ -0,0 +1,16 @@
+#pragma once
+
+#include "../board/position.h"
+
+// ==================== KNOWN ENDGAMES ===========================
+// Specialised evaluators picked by the material table. They replace the
+// whole evaluation and return a side to move relative score.
+// ============================================================================
+
+namespace ASTROVE::eval {
+
+    // bare king against mating material: drive it to the edge
+    template <Color strong>
+    int evaluate_KXK(const Position& pos);
+
+} // namespace ASTROVE::eval
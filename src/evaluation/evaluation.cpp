@@ -1,6 +1,9 @@
 #include "evaluation.h"
 #include "../core/types.h"
 #include "psqt.h"
+#include "nnue.h"
+#include "pawn.h"
+#include "material.h"
 #include <algorithm>
 
 namespace ASTROVE::eval {
@@ -8,9 +11,19 @@ namespace ASTROVE::eval {
     Evaluator board_evaluator;
 
     Score Evaluator::evaluate_board(const Position& pos) {
+        if (nnue::enabled) {
+            return Score(nnue::evaluate(pos, accumulators));
+        }
+
         initialize(pos);
 
+        // known endgames have their own evaluation
+        if (material->endgame) {
+            return Score(material->endgame(pos));
+        }
+
         evaluate_material_and_placement(pos);
+        evaluate_pawns(pos);
 
         Score result = calculate_final_score(pos);
         
@@ -19,37 +32,27 @@ namespace ASTROVE::eval {
 
     void Evaluator::initialize(const Position& pos) {
         evalData = EvaluationData{};
+        material = probe_material(pos, materialTable);
     }
     
     void Evaluator::evaluate_material_and_placement(const Position& pos) {
-    for (Square sq = SQ_A1; sq <= SQ_H8; sq = Square(sq + 1)) {
-        Piece piece = pos.pieceAt(sq);
-        if (piece == None) continue;
-        
-        Color c = piececolor(piece);
-        PieceType pt = piecetype(piece);
-        
-        if (pt == King) continue;  // Don't evaluate king material
-        
-        EvalScore materialVal = PieceValues[pt];
-        EvalScore psqtVal = PSQT[pt][c][sq];
-        
-        evalData.add((c == White) ? (materialVal + psqtVal) : -(materialVal + psqtVal));
+        // summed incrementally by makemove (kings carry no material)
+        evalData.add(pos.psqScore());
+        evalData.add(material->imbalance);
     }
+
+    void Evaluator::evaluate_pawns(const Position& pos) {
+        // structure is cached by pawn key, shelter by king square on top
+        PawnEntry* entry = probe_pawns(pos, pawnTable);
+        evalData.add(entry->score);
+        evalData.add(king_shelter<White>(pos, entry) - king_shelter<Black>(pos, entry));
     }
 
 
-int Evaluator::calculate_game_phase(const Position& pos) const {
-    
-    int phase = 0;
-    phase += popcount(pos.knights<White>()) + popcount(pos.knights<Black>());
-    phase += popcount(pos.bishops<White>()) + popcount(pos.bishops<Black>());
-    phase += 2 * (popcount(pos.rooks<White>()) + popcount(pos.rooks<Black>()));
-    phase += 4 * (popcount(pos.queens<White>()) + popcount(pos.queens<Black>()));
+int Evaluator::calculate_game_phase(const Position&) const {
     
-    phase = std::clamp(phase, 0, 24);
-    
-    return phase;
+    // cached per material configuration
+    return material->phase;
 }
 
 Score Evaluator::calculate_final_score(const Position& pos) const {
@@ -67,6 +70,9 @@ Score Evaluator::calculate_final_score(const Position& pos) const {
     Score opening = openingScore(score);
     Score endgame = endgameScore(score);
 
+    // drawish material only scales the side that is ahead
+    endgame = endgame * material->scaleFactor[endgame > 0 ? White : Black] / SCALE_FACTOR_NORMAL;
+
     Score finalScore = (opening * phase + endgame * (maxPhase - phase)) / maxPhase;
     
     Score result = (pos.sideToMove() == White) ? finalScore : -finalScore;
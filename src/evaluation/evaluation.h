@@ -2,6 +2,9 @@
 
 #include "psqt.h"       // Piece-square tables
 #include "../board/position.h"
+#include "../table/pawn_tt.h"
+#include "../table/material_cache.h"
+#include "nnue.h"
 #include <cstdint>
 #include <array>
 
@@ -10,17 +13,19 @@ namespace eval{
     using EvalScore = int32_t;
     using Score = int16_t;
 
-    // Compose a combined evaluation with opening and endgame parts
+    // Compose a combined evaluation with opening and endgame parts,
+    // endgame * 2^16 + opening so that sums of scores stay sums of both parts
     constexpr EvalScore composeEval(Score opening, Score endgame) {
-        return static_cast<EvalScore>((static_cast<int32_t>(endgame) << 16) | static_cast<uint16_t>(opening));
+        return static_cast<EvalScore>((static_cast<uint32_t>(endgame) << 16) + static_cast<uint32_t>(opening));
     }
 
     // Extract opening and endgame from combined EvalScore
     constexpr Score openingScore(EvalScore score) {
         return static_cast<Score>(static_cast<int16_t>(score & 0xFFFF));
     }
+    // a negative opening part borrowed one from the endgame part, round it back
     constexpr Score endgameScore(EvalScore score) {
-        return static_cast<Score>(static_cast<int16_t>(score >> 16));
+        return static_cast<Score>(static_cast<int16_t>((static_cast<uint32_t>(score) + 0x8000u) >> 16));
     }
 
     // Evaluation constants
@@ -59,9 +64,14 @@ namespace eval{
 
     private:
         EvaluationData evalData;
+        PawnTable pawnTable;    // per evaluator, so per search thread
+        MaterialTable materialTable;
+        MaterialEntry* material = nullptr;  // entry of the position being evaluated
+        nnue::AccumulatorStack accumulators;
 
         void initialize(const Position& pos);
         void evaluate_material_and_placement(const Position& pos);
+        void evaluate_pawns(const Position& pos);
 
         int calculate_game_phase(const Position& pos) const;
         Score calculate_final_score(const Position& pos) const;
@@ -0,0 +1,68 @@
+#include "material.h"
+#include "evaluation.h"
+#include "../endgame/endgame.h"
+#include <algorithm>
+
+namespace ASTROVE::eval {
+
+    // ===== IMBALANCE WEIGHTS =====
+    constexpr EvalScore BishopPair = composeEval(30, 50);
+    // per own pawn above (or below) five: knights like closed positions, rooks open ones
+    constexpr EvalScore KnightPawnAdjust = composeEval(3, 3);
+    constexpr EvalScore RookPawnAdjust = composeEval(-6, -6);
+
+    constexpr int BishopValue = openingScore(PieceValues[Bishop]);
+    constexpr int RookValue = openingScore(PieceValues[Rook]);
+
+    template <Color c>
+    int non_pawn_material(const Position& pos) {
+        return popcount(pos.knights<c>()) * openingScore(PieceValues[Knight])
+             + popcount(pos.bishops<c>()) * BishopValue
+             + popcount(pos.rooks<c>())   * RookValue
+             + popcount(pos.queens<c>())  * openingScore(PieceValues[Queen]);
+    }
+
+    template <Color c>
+    EvalScore imbalance(const Position& pos) {
+        const int pawns = popcount(pos.pawns<c>()) - 5;
+        EvalScore score = 0;
+        if (popcount(pos.bishops<c>()) >= 2) score += BishopPair;
+        score += KnightPawnAdjust * (popcount(pos.knights<c>()) * pawns);
+        score += RookPawnAdjust * (popcount(pos.rooks<c>()) * pawns);
+        return score;
+    }
+
+    // without pawns a small material edge rarely wins
+    template <Color c>
+    uint8_t scale_factor(const Position& pos, int npmUs, int npmThem) {
+        if (!pos.pawns<c>() && npmUs - npmThem <= BishopValue) {
+            return npmUs < RookValue ? SCALE_FACTOR_DRAW : npmThem <= BishopValue ? 4 : 14;
+        }
+        return SCALE_FACTOR_NORMAL;
+    }
+
+    MaterialEntry* probe_material(const Position& pos, MaterialTable& table) {
+        MaterialEntry* entry = table.probe(pos.materialKey());
+        if (entry->key == pos.materialKey()) {
+            return entry;
+        }
+
+        const int npmWhite = non_pawn_material<White>(pos);
+        const int npmBlack = non_pawn_material<Black>(pos);
+
+        entry->key = pos.materialKey();
+        entry->phase = std::clamp(pos.gamePhase(), 0, 24);
+        entry->imbalance = imbalance<White>(pos) - imbalance<Black>(pos);
+        entry->scaleFactor[White] = scale_factor<White>(pos, npmWhite, npmBlack);
+        entry->scaleFactor[Black] = scale_factor<Black>(pos, npmBlack, npmWhite);
+
+        entry->endgame = nullptr;
+        if (!pos.pawns<Black>() && !npmBlack && npmWhite >= RookValue) {
+            entry->endgame = evaluate_KXK<White>;
+        } else if (!pos.pawns<White>() && !npmWhite && npmBlack >= RookValue) {
+            entry->endgame = evaluate_KXK<Black>;
+        }
+        return entry;
+    }
+
+} // namespace ASTROVE::eval
@@ -0,0 +1,11 @@
+#pragma once
+
+#include "../board/position.h"
+#include "../table/material_cache.h"
+
+namespace ASTROVE::eval {
+
+    // entry of the position's material configuration, computed on a miss
+    MaterialEntry* probe_material(const Position& pos, MaterialTable& table);
+
+} // namespace ASTROVE::eval
@@ -0,0 +1,294 @@
+#include "nnue.h"
+#include "evaluation.h"
+#include "../board/position.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <memory>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE4_1__)
+#include <smmintrin.h>
+#endif
+
+namespace ASTROVE::nnue {
+
+Network network;
+uint32_t networkVersion = 0;
+bool enabled = false;
+
+namespace {
+
+    // "ASNN" little endian, bumped when the layout changes
+    constexpr uint32_t NET_MAGIC = 0x4E4E5341;
+    constexpr uint32_t NET_VERSION = 1;
+
+    // past this many changed pieces a refresh is cheaper than updating
+    constexpr int REFRESH_COST = 24;
+    constexpr int MAX_UPDATE_CHAIN = 32;
+
+    // keeps the score clear of tablebase and mate scores
+    constexpr int EVAL_LIMIT = 29000;
+
+    inline int featureIndex(Color perspective, Piece pc, Square sq) {
+        Color c = piececolor(pc);
+        if (perspective == Black) {
+            c = ~c;
+            sq = Square(sq ^ 56);
+        }
+        return (c * 6 + piecetype(pc)) * 64 + sq;
+    }
+
+    // ===== KERNELS =====
+#if defined(__AVX2__)
+    constexpr int VEC = 16;     // int16 lanes
+
+    inline void addColumn(int16_t* acc, const int16_t* w) {
+        for (int i = 0; i < HIDDEN; i += VEC) {
+            __m256i a = _mm256_load_si256(reinterpret_cast<const __m256i*>(acc + i));
+            __m256i b = _mm256_load_si256(reinterpret_cast<const __m256i*>(w + i));
+            _mm256_store_si256(reinterpret_cast<__m256i*>(acc + i), _mm256_add_epi16(a, b));
+        }
+    }
+    inline void subColumn(int16_t* acc, const int16_t* w) {
+        for (int i = 0; i < HIDDEN; i += VEC) {
+            __m256i a = _mm256_load_si256(reinterpret_cast<const __m256i*>(acc + i));
+            __m256i b = _mm256_load_si256(reinterpret_cast<const __m256i*>(w + i));
+            _mm256_store_si256(reinterpret_cast<__m256i*>(acc + i), _mm256_sub_epi16(a, b));
+        }
+    }
+    // sum of clamp(acc, 0, QA) * w
+    inline int32_t creluDot(const int16_t* acc, const int16_t* w) {
+        const __m256i zero = _mm256_setzero_si256();
+        const __m256i qa = _mm256_set1_epi16(QA);
+        __m256i sum = _mm256_setzero_si256();
+        for (int i = 0; i < HIDDEN; i += VEC) {
+            __m256i a = _mm256_load_si256(reinterpret_cast<const __m256i*>(acc + i));
+            __m256i b = _mm256_load_si256(reinterpret_cast<const __m256i*>(w + i));
+            a = _mm256_min_epi16(_mm256_max_epi16(a, zero), qa);
+            sum = _mm256_add_epi32(sum, _mm256_madd_epi16(a, b));
+        }
+        __m128i s = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+        s = _mm_add_epi32(s, _mm_shuffle_epi32(s, 0x4E));
+        s = _mm_add_epi32(s, _mm_shuffle_epi32(s, 0xB1));
+        return _mm_cvtsi128_si32(s);
+    }
+#elif defined(__SSE4_1__)
+    constexpr int VEC = 8;
+
+    inline void addColumn(int16_t* acc, const int16_t* w) {
+        for (int i = 0; i < HIDDEN; i += VEC) {
+            __m128i a = _mm_load_si128(reinterpret_cast<const __m128i*>(acc + i));
+            __m128i b = _mm_load_si128(reinterpret_cast<const __m128i*>(w + i));
+            _mm_store_si128(reinterpret_cast<__m128i*>(acc + i), _mm_add_epi16(a, b));
+        }
+    }
+    inline void subColumn(int16_t* acc, const int16_t* w) {
+        for (int i = 0; i < HIDDEN; i += VEC) {
+            __m128i a = _mm_load_si128(reinterpret_cast<const __m128i*>(acc + i));
+            __m128i b = _mm_load_si128(reinterpret_cast<const __m128i*>(w + i));
+            _mm_store_si128(reinterpret_cast<__m128i*>(acc + i), _mm_sub_epi16(a, b));
+        }
+    }
+    inline int32_t creluDot(const int16_t* acc, const int16_t* w) {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i qa = _mm_set1_epi16(QA);
+        __m128i sum = _mm_setzero_si128();
+        for (int i = 0; i < HIDDEN; i += VEC) {
+            __m128i a = _mm_load_si128(reinterpret_cast<const __m128i*>(acc + i));
+            __m128i b = _mm_load_si128(reinterpret_cast<const __m128i*>(w + i));
+            a = _mm_min_epi16(_mm_max_epi16(a, zero), qa);
+            sum = _mm_add_epi32(sum, _mm_madd_epi16(a, b));
+        }
+        sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0x4E));
+        sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0xB1));
+        return _mm_cvtsi128_si32(sum);
+    }
+#else
+    inline void addColumn(int16_t* acc, const int16_t* w) {
+        for (int i = 0; i < HIDDEN; ++i) acc[i] += w[i];
+    }
+    inline void subColumn(int16_t* acc, const int16_t* w) {
+        for (int i = 0; i < HIDDEN; ++i) acc[i] -= w[i];
+    }
+    inline int32_t creluDot(const int16_t* acc, const int16_t* w) {
+        int32_t sum = 0;
+        for (int i = 0; i < HIDDEN; ++i)
+            sum += std::clamp<int32_t>(acc[i], 0, QA) * w[i];
+        return sum;
+    }
+#endif
+
+    // ===== ACCUMULATORS =====
+    void refresh(const Position& pos, Accumulator& acc) {
+        for (Color p : {White, Black}) {
+            std::memcpy(acc.values[p], network.featureBias, sizeof(network.featureBias));
+            Bitboard occ = pos.occupancy();
+            while (occ) {
+                Square sq = Square(__builtin_ctzll(occ));
+                occ &= occ - 1;
+                addColumn(acc.values[p], &network.featureWeights[featureIndex(p, pos.pieceAt(sq), sq) * HIDDEN]);
+            }
+        }
+    }
+
+    void applyDirty(Accumulator& acc, const DirtyPieces& dirty) {
+        for (int i = 0; i < dirty.count; ++i) {
+            for (Color p : {White, Black}) {
+                const int16_t* w = &network.featureWeights[featureIndex(p, dirty.piece[i], dirty.square[i]) * HIDDEN];
+                if (dirty.added[i]) addColumn(acc.values[p], w);
+                else subColumn(acc.values[p], w);
+            }
+        }
+    }
+
+    inline bool upToDate(const Accumulator& acc, const StateInfo* s) {
+        return acc.computed && acc.key == s->hashKey;
+    }
+
+    // walk back to the closest computed accumulator and replay the moves
+    // from there, only the current state ends up computed. A state's
+    // previous one sits one index lower in the state stack.
+    void update(const Position& pos, AccumulatorStack& accumulators) {
+        const StateInfo* st = pos.stateInfo();
+        int top = pos.stateIndex();
+        Accumulator& acc = accumulators.at(top);
+
+        const StateInfo* chain[MAX_UPDATE_CHAIN];
+        int length = 0;
+        int changed = 0;
+
+        const StateInfo* s = st;
+        int index = top;
+        while (!upToDate(accumulators.at(index), s)) {
+            changed += s->dirty.count;
+            if (!s->previous || length == MAX_UPDATE_CHAIN || changed > REFRESH_COST) {
+                refresh(pos, acc);
+                acc.key = st->hashKey;
+                acc.computed = true;
+                return;
+            }
+            chain[length++] = s;
+            s = s->previous;
+            index--;
+        }
+
+        std::memcpy(acc.values, accumulators.at(index).values, sizeof(acc.values));
+        for (int i = length - 1; i >= 0; --i) {
+            applyDirty(acc, chain[i]->dirty);
+        }
+        acc.key = st->hashKey;
+        acc.computed = true;
+    }
+
+    template <typename T>
+    bool readArray(std::istream& is, T* data, size_t count) {
+        is.read(reinterpret_cast<char*>(data), sizeof(T) * count);
+        return bool(is);
+    }
+
+} // namespace
+
+// The default net reproduces material + PSQT. Hidden neuron
+// (owner, mg/eg, piece type, file pair) sums the values of those pieces in
+// units of 4cp, the output weights of a bucket taper mg against eg with the
+// bucket's phase, own pieces count positive and enemy pieces negative.
+void init() {
+    using namespace ASTROVE::eval;
+    constexpr int UNIT = 4;
+
+    std::memset(&network, 0, sizeof(network));
+
+    auto neuron = [](int owner, int term, int pt, int filePair) {
+        return ((owner * 2 + term) * 5 + pt) * 4 + filePair;
+    };
+
+    // rows for the white perspective, black mirrors onto the same rows
+    for (int c = White; c <= Black; ++c) {
+        for (int pt = Pawn; pt < King; ++pt) {
+            for (int sq = 0; sq < 64; ++sq) {
+                EvalScore value = PieceValues[pt] + PSQT[pt][c][sq];
+                int16_t* row = &network.featureWeights[(c * 6 + pt) * 64 * HIDDEN + sq * HIDDEN];
+                row[neuron(c, 0, pt, (sq & 7) / 2)] = int16_t(std::lround(openingScore(value) / double(UNIT)));
+                row[neuron(c, 1, pt, (sq & 7) / 2)] = int16_t(std::lround(endgameScore(value) / double(UNIT)));
+            }
+        }
+    }
+
+    // both perspectives see every piece, each carries half of it
+    constexpr double toOutput = 0.5 * UNIT * QA * QB / EVAL_SCALE;
+    for (int b = 0; b < OUTPUT_BUCKETS; ++b) {
+        double mg = (3 * b + 1.5) / 24.0;
+        for (int side = 0; side < 2; ++side) {          // side to move, other side
+            for (int owner = 0; owner < 2; ++owner) {   // own, enemy
+                double sign = (side == owner) ? 1.0 : -1.0;
+                for (int pt = Pawn; pt < King; ++pt) {
+                    for (int f = 0; f < 4; ++f) {
+                        int16_t* w = &network.outputWeights[b][side * HIDDEN];
+                        w[neuron(owner, 0, pt, f)] = int16_t(std::lround(sign * mg * toOutput));
+                        w[neuron(owner, 1, pt, f)] = int16_t(std::lround(sign * (1.0 - mg) * toOutput));
+                    }
+                }
+            }
+        }
+        network.outputBias[b] = int16_t(std::lround(10.0 * QA * QB / EVAL_SCALE));  // tempo
+    }
+    networkVersion++;
+}
+
+// header (magic, version, hidden size, buckets) then the arrays of
+// Network in order, little endian int16
+bool load(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) return false;
+
+    uint32_t header[4];
+    if (!readArray(file, header, 4)) return false;
+    if (header[0] != NET_MAGIC || header[1] != NET_VERSION ||
+        header[2] != HIDDEN || header[3] != OUTPUT_BUCKETS) {
+        return false;
+    }
+
+    auto net = std::make_unique<Network>();
+    if (!readArray(file, net->featureWeights, INPUTS * HIDDEN) ||
+        !readArray(file, net->featureBias, HIDDEN) ||
+        !readArray(file, &net->outputWeights[0][0], OUTPUT_BUCKETS * 2 * HIDDEN) ||
+        !readArray(file, net->outputBias, OUTPUT_BUCKETS)) {
+        return false;
+    }
+    // trailing bytes mean a different architecture
+    if (file.peek() != std::ifstream::traits_type::eof()) return false;
+
+    network = *net;
+    networkVersion++;
+    return true;
+}
+
+void AccumulatorStack::prepare(uint32_t currentVersion) {
+    if (entries.empty()) {
+        entries.resize(SIZE);
+    } else if (version != currentVersion) {
+        for (Accumulator& acc : entries) acc.computed = false;
+    }
+    version = currentVersion;
+}
+
+int evaluate(const Position& pos, AccumulatorStack& accumulators) {
+    accumulators.prepare(networkVersion);
+    if (!upToDate(accumulators.at(pos.stateIndex()), pos.stateInfo())) update(pos, accumulators);
+    const Accumulator& acc = accumulators.at(pos.stateIndex());
+
+    Color us = pos.sideToMove();
+    int bucket = std::min(pos.gamePhase(), 23) / 3;
+    const int16_t* weights = network.outputWeights[bucket];
+
+    int32_t sum = creluDot(acc.values[us], weights)
+                + creluDot(acc.values[~us], weights + HIDDEN);
+    int score = int(int64_t(sum + network.outputBias[bucket]) * EVAL_SCALE / (QA * QB));
+
+    return std::clamp(score, -EVAL_LIMIT, EVAL_LIMIT);
+}
+
+} // namespace ASTROVE::nnue
@@ -0,0 +1,100 @@
+#pragma once
+
+#include "../core/types.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class Position;
+
+// ==================== NNUE ===========================
+// An efficiently updatable network: 768 -> 128 (x2 perspectives) -> 1
+//
+// 1. Features are (piece colour relative to the perspective, piece type,
+//    square seen from that perspective), both perspectives share weights.
+// 2. Every search thread keeps an int16 accumulator (the 128 hidden sums
+//    per perspective) for each entry of the position's state stack.
+//    makemove only records in the StateInfo which pieces changed, the
+//    accumulator is brought up to date lazily when the position is
+//    evaluated, from the closest ancestor that was, or refreshed.
+// 3. Output = clipped relu of side to move ++ other side, dot the weights
+//    of one of 8 output buckets picked by game phase.
+//
+// Without a network file an embedded default built from the PSQT tables
+// is used, it plays like the classical evaluation.
+// ============================================================================
+
+namespace ASTROVE::nnue {
+
+constexpr int INPUTS = 768;         // 2 colours x 6 piece types x 64 squares
+constexpr int HIDDEN = 128;
+constexpr int OUTPUT_BUCKETS = 8;
+
+// quantisation: accumulator 1.0 = QA, output weight 1.0 = QB
+constexpr int QA = 255;
+constexpr int QB = 64;
+constexpr int EVAL_SCALE = 400;
+
+// pieces put on or taken off the board by one move, castling moves four
+struct DirtyPieces {
+    int count = 0;
+    Piece piece[4];
+    Square square[4];
+    bool added[4];
+
+    void clear() { count = 0; }
+    void push(Piece pc, Square sq, bool add) {
+        piece[count] = pc;
+        square[count] = sq;
+        added[count] = add;
+        count++;
+    }
+};
+
+struct alignas(64) Accumulator {
+    int16_t values[2][HIDDEN];      // indexed by perspective
+    uint64_t key = 0;               // hash key of the state it was computed for
+    bool computed = false;
+};
+
+// One accumulator per entry of a Position's state stack, indexed like it.
+// Every Evaluator owns one, so every search thread. The state at an index
+// changes with every move made there, an entry is only trusted while the
+// key matches and no other network was loaded since. Allocated on the
+// first nnue evaluation, so it costs nothing while the classical
+// evaluation is used.
+class AccumulatorStack {
+public:
+    static constexpr int SIZE = 1024;   // states of a Position
+
+    Accumulator& at(int index) { return entries[index]; }
+    // drops every entry if the network changed, allocates on first use
+    void prepare(uint32_t networkVersion);
+
+private:
+    std::vector<Accumulator> entries;
+    uint32_t version = 0;
+};
+
+struct alignas(64) Network {
+    int16_t featureWeights[INPUTS * HIDDEN];
+    int16_t featureBias[HIDDEN];
+    int16_t outputWeights[OUTPUT_BUCKETS][2 * HIDDEN];
+    int16_t outputBias[OUTPUT_BUCKETS];
+};
+
+extern Network network;
+// bumped whenever the network is replaced
+extern uint32_t networkVersion;
+// set by the "Use NNUE" uci option
+extern bool enabled;
+
+// builds the embedded default network, needs the PSQT tables
+void init();
+// returns false (and keeps the current network) if the file is not valid
+bool load(const std::string& path);
+
+// side to move relative, in centipawns
+int evaluate(const Position& pos, AccumulatorStack& accumulators);
+
+} // namespace ASTROVE::nnue
@@ -0,0 +1,129 @@
+#include "pawn.h"
+#include "evaluation.h"
+#include <algorithm>
+
+namespace ASTROVE::eval {
+
+    // ===== PAWN STRUCTURE WEIGHTS =====
+    constexpr EvalScore DoubledPenalty  = composeEval(-10, -25);
+    constexpr EvalScore IsolatedPenalty = composeEval(-6, -14);
+    constexpr EvalScore BackwardPenalty = composeEval(-8, -10);
+
+    // by relative rank, the psqt already rewards advanced pawns
+    constexpr EvalScore PassedBonus[8] = {
+        composeEval(0, 0),   composeEval(2, 8),   composeEval(5, 12),  composeEval(8, 20),
+        composeEval(15, 35), composeEval(25, 60), composeEval(40, 100), composeEval(0, 0)
+    };
+
+    // ===== KING SHELTER WEIGHTS =====
+    // by ranks between the king and the closest own pawn in front of it
+    constexpr EvalScore ShelterPawn[3] = { composeEval(10, 0), composeEval(4, 0), composeEval(-6, 0) };
+    constexpr EvalScore ShelterMissing = composeEval(-20, 0);
+    constexpr EvalScore ShelterOpenFile = composeEval(-10, 0);
+
+    template <Color c>
+    inline Bitboard pawn_attacks_bb(Bitboard pawns) {
+        if constexpr (c == White) {
+            return ((pawns << 7) & ~MASKFILE[FILE_H]) | ((pawns << 9) & ~MASKFILE[FILE_A]);
+        } else {
+            return ((pawns >> 9) & ~MASKFILE[FILE_H]) | ((pawns >> 7) & ~MASKFILE[FILE_A]);
+        }
+    }
+
+    inline Bitboard adjacent_files(File f) {
+        return (f > FILE_A ? MASKFILE[f - 1] : 0) | (f < FILE_H ? MASKFILE[f + 1] : 0);
+    }
+
+    template <Color c>
+    EvalScore evaluate_pawns(const Position& pos, PawnEntry* entry) {
+        const Bitboard ours = pos.pawns<c>();
+        const Bitboard theirs = pos.pawns<~c>();
+        EvalScore score = 0;
+
+        entry->passed[c] = entry->attackSpans[c] = 0;
+        entry->semiOpenFiles[c] = 0xFF;
+
+        Bitboard b = ours;
+        while (b) {
+            Square sq = poplsb(b);
+            File f = fileof(sq);
+            int r = (c == White) ? rankof(sq) : 7 - rankof(sq);
+
+            Bitboard ahead = MASKPASSED[c][sq];
+            Bitboard neighbours = adjacent_files(f);
+            Bitboard behindOrLevel = (c == White) ? BBRANKSPAN[0][rankof(sq)] : BBRANKSPAN[rankof(sq)][7];
+            Square stop = Square(c == White ? sq + 8 : sq - 8);
+
+            entry->semiOpenFiles[c] &= ~(1 << f);
+            entry->attackSpans[c] |= ahead & neighbours;
+
+            bool doubled = ours & ahead & MASKFILE[f];
+            bool isolated = !(ours & neighbours);
+            // no neighbour can come to its help and its stop square is guarded
+            bool backward = !isolated
+                         && !(ours & neighbours & behindOrLevel)
+                         && (entry->attacks[~c] & bb(stop));
+
+            if (doubled)  score += DoubledPenalty;
+            if (isolated) score += IsolatedPenalty;
+            if (backward) score += BackwardPenalty;
+
+            // only the front pawn of a file can be passed
+            if (!(theirs & ahead) && !doubled) {
+                entry->passed[c] |= bb(sq);
+                score += PassedBonus[r];
+            }
+        }
+        return score;
+    }
+
+    PawnEntry* probe_pawns(const Position& pos, PawnTable& table) {
+        PawnEntry* entry = table.probe(pos.pawnKey());
+        if (entry->key == pos.pawnKey()) {
+            return entry;
+        }
+
+        entry->key = pos.pawnKey();
+        entry->kingSquare[White] = entry->kingSquare[Black] = NO_SQ;
+        // backward pawns need the enemy attacks first
+        entry->attacks[White] = pawn_attacks_bb<White>(pos.pawns<White>());
+        entry->attacks[Black] = pawn_attacks_bb<Black>(pos.pawns<Black>());
+        entry->score = evaluate_pawns<White>(pos, entry) - evaluate_pawns<Black>(pos, entry);
+        return entry;
+    }
+
+    template <Color c>
+    EvalScore king_shelter(const Position& pos, PawnEntry* entry) {
+        Square ksq = pos.kingsq<c>();
+        if (entry->kingSquare[c] == ksq) {
+            return entry->kingShelter[c];
+        }
+
+        const Bitboard ours = pos.pawns<c>();
+        const Bitboard theirs = pos.pawns<~c>();
+        // the squares in front of the king, its own rank included
+        Bitboard front = (c == White) ? BBRANKSPAN[rankof(ksq)][7] : BBRANKSPAN[0][rankof(ksq)];
+        int center = std::clamp(int(fileof(ksq)), int(FILE_B), int(FILE_G));
+
+        EvalScore shelter = 0;
+        for (int f = center - 1; f <= center + 1; ++f) {
+            Bitboard shield = ours & front & MASKFILE[f];
+            if (!shield) {
+                shelter += ShelterMissing;
+                if (!(theirs & MASKFILE[f])) shelter += ShelterOpenFile;
+                continue;
+            }
+            Square closest = (c == White) ? getlsb(shield) : getmsb(shield);
+            int distance = std::abs(rankof(closest) - rankof(ksq));
+            shelter += ShelterPawn[std::min(std::max(distance, 1), 3) - 1];
+        }
+
+        entry->kingSquare[c] = ksq;
+        entry->kingShelter[c] = shelter;
+        return shelter;
+    }
+
+    template EvalScore king_shelter<White>(const Position& pos, PawnEntry* entry);
+    template EvalScore king_shelter<Black>(const Position& pos, PawnEntry* entry);
+
+} // namespace ASTROVE::eval
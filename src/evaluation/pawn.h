@@ -0,0 +1,15 @@
+#pragma once
+
+#include "../board/position.h"
+#include "../table/pawn_tt.h"
+
+namespace ASTROVE::eval {
+
+    // entry of the position's pawn structure, computed on a miss
+    PawnEntry* probe_pawns(const Position& pos, PawnTable& table);
+
+    // pawn shield in front of c's king, cached in the entry per king square
+    template <Color c>
+    EvalScore king_shelter(const Position& pos, PawnEntry* entry);
+
+} // namespace ASTROVE::eval
@@ -164,6 +164,7 @@ namespace ASTROVE::eval{
 
     //defines the array declared in psqt.h
     EvalScore PSQT[6][2][64];
+    EvalScore PieceSquareScore[12][64];
 
     // Indexed by Piece enum
     const int PiecePhaseValue[12] = {
@@ -184,6 +185,12 @@ namespace ASTROVE::eval{
 
                 //Black PSQT entry(scores stored positive)
                 PSQT[pType][Black][sq]=composeEval(mgPsqtPtrs[pType][FLIP(sq)],egPsqtPtrs[pType][FLIP(sq)]);
+
+                //Combined entries for the incremental score in Position
+                EvalScore white = (pType == King) ? 0 : PieceValues[pType] + PSQT[pType][White][sq];
+                EvalScore black = (pType == King) ? 0 : PieceValues[pType] + PSQT[pType][Black][sq];
+                PieceSquareScore[pType][sq] = white;
+                PieceSquareScore[pType + 6][sq] = -black;
             }
         }   
     }
@@ -10,6 +10,10 @@ namespace ASTROVE::eval {
     //---------- Piece-Square Tables (Tapered) ------------
     extern EvalScore PSQT[6][2][64];
 
+    // material + psqt by piece (WhitePawn..BlackKing), black entries negated
+    // and kings zero, so a position's sum is what the evaluation loop found
+    extern EvalScore PieceSquareScore[12][64];
+
     //Game Phase Values
     extern const int PiecePhaseValue[12]; //using 12 values for WhitePawn..BlackKing
 
@@ -0,0 +1,11 @@
+#include "counter.h"
+#include <algorithm>
+#include <cstring>
+
+void CounterMoveTable::clear() {
+    std::fill(&table[0][0], &table[0][0] + 12 * 64, NO_MOVE);
+}
+
+void ContinuationHistory::clear() {
+    std::memset(table, 0, sizeof(table));
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include "../core/types.h"
+#include "../core/move.h"
+#include "history.h"
+#include <cstdint>
+
+// ==================== MOVE PAIR HEURISTICS ===========================
+// Quiet moves judged by the moves played before them. Both tables are
+// indexed by the previous move's piece and to-square, the piece is the
+// one standing there after the move (the promoted one for promotions).
+//
+// The counter move is the last quiet that refuted a move. Continuation
+// history keeps, for every earlier move, a [piece][to] history of the
+// replies; the search stack points every ply at the slice of the move
+// played there, so scoring a quiet is one indirection per earlier ply.
+// One table serves the 1-ply and the 2-ply continuation.
+// ============================================================================
+
+class CounterMoveTable {
+public:
+    Move get(Piece pc, Square to) const { return table[pc][to]; }
+    void set(Piece pc, Square to, Move move) { table[pc][to] = move; }
+    void clear();
+
+private:
+    Move table[12][64];
+};
+
+// history of the replies to one earlier move
+struct PieceToHistory {
+    int get(Piece pc, Square to) const { return table[pc][to]; }
+    void update(Piece pc, Square to, int bonus) { applyGravity(table[pc][to], bonus); }
+
+    int16_t table[12][64];
+};
+
+class ContinuationHistory {
+public:
+    PieceToHistory* slice(Piece pc, Square to) { return &table[pc][to]; }
+
+    // stands in for null moves and plies above the root, never updated
+    // so it stays at zero
+    PieceToHistory* sentinel() { return &table[None][0]; }
+
+    void clear();
+
+private:
+    PieceToHistory table[13][64];   // None row for the sentinel
+};
@@ -0,0 +1,10 @@
+#include "history.h"
+#include <cstring>
+
+void ButterflyHistory::clear() {
+    std::memset(table, 0, sizeof(table));
+}
+
+void CaptureHistory::clear() {
+    std::memset(table, 0, sizeof(table));
+}
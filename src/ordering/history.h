@@ -0,0 +1,61 @@
+#pragma once
+#include "../core/types.h"
+#include "../core/move.h"
+#include "../board/position.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+
+// ==================== HISTORY HEURISTICS ===========================
+// How often a move caused a beta cutoff elsewhere in the tree. A cutoff
+// rewards the move that caused it and punishes the moves searched before
+// it at the same node. Updates use the "gravity" formula
+//
+//   entry += bonus - entry * |bonus| / HISTORY_MAX
+//
+// which shrinks a bonus as the entry approaches the bound, so old results
+// fade out and no entry ever leaves [-HISTORY_MAX, HISTORY_MAX].
+// Each search thread owns its tables, they are kept between searches and
+// only cleared on ucinewgame.
+// ============================================================================
+
+constexpr int HISTORY_MAX = 16384;
+
+// deeper cutoffs are worth more, capped so one result cannot dominate
+inline int historyBonus(int depth) {
+    return std::min(250 * depth - 150, 1500);
+}
+
+inline void applyGravity(int16_t& entry, int bonus) {
+    bonus = std::clamp(bonus, -HISTORY_MAX, HISTORY_MAX);
+    entry += bonus - entry * std::abs(bonus) / HISTORY_MAX;
+}
+
+// quiet moves, indexed by side to move and from/to square
+class ButterflyHistory {
+public:
+    int get(Color c, Move move) const { return table[c][move.from()][move.to()]; }
+    void update(Color c, Move move, int bonus) { applyGravity(table[c][move.from()][move.to()], bonus); }
+    void clear();
+
+private:
+    int16_t table[2][64][64];
+};
+
+// captures and queen promotions, indexed by moving piece, target square
+// and captured piece type (Nonetype for a quiet promotion)
+class CaptureHistory {
+public:
+    int get(const Position& pos, Move move) const { return table[pos.pieceAt(move.from())][move.to()][captured(pos, move)]; }
+    void update(const Position& pos, Move move, int bonus) {
+        applyGravity(table[pos.pieceAt(move.from())][move.to()][captured(pos, move)], bonus);
+    }
+    void clear();
+
+private:
+    static PieceType captured(const Position& pos, Move move) {
+        return (move.flag() == EnPassant) ? Pawn : piecetype(pos.pieceAt(move.to()));
+    }
+
+    int16_t table[12][64][7];
+};
@@ -1,214 +1,148 @@
 #include "ordering.h"
-#include "../core/attacks.h"
 #include <cstring>
 #include <algorithm>
 
 
-// Returns the bitboard of attackers of given color on square `sq`
-Bitboard MoveOrderer::attackersForSide(const Position& pos, Color attackerColor, Square sq, Bitboard occupiedBB) {
-    Bitboard attackingBishops = pos.getPiecesBB(makepiece(attackerColor, Bishop));
-    Bitboard attackingRooks   = pos.getPiecesBB(makepiece(attackerColor, Rook));
-    Bitboard attackingQueens  = pos.getPiecesBB(makepiece(attackerColor, Queen));
-    Bitboard attackingKnights = pos.getPiecesBB(makepiece(attackerColor, Knight));
-    Bitboard attackingKing    = pos.getPiecesBB(makepiece(attackerColor, King));
-    Bitboard attackingPawns   = pos.getPiecesBB(makepiece(attackerColor, Pawn));
+void MoveOrderer::clear() {
+    mainHistory.clear();
+    captureHistory.clear();
+    counterMoves.clear();
+    contHistory.clear();
+}
 
-    Bitboard diagonalAttacks = Attacks::get_bishop_attacks(sq, occupiedBB);
-    Bitboard orthogonalAttacks = Attacks::get_rook_attacks(sq, occupiedBB);
+void MoveOrderer::updateHistories(const Position& pos, Move bestMove, int depth,
+                                  const Move* quiets, int quietCount,
+                                  const Move* captures, int captureCount,
+                                  PieceToHistory* const contHist[2], Move prevMove) {
+    Color us = pos.sideToMove();
+    int bonus = historyBonus(depth);
+
+    // the sentinel slice stays untouched
+    auto updateQuiet = [&](Move move, int value) {
+        Piece pc = pos.pieceAt(move.from());
+        mainHistory.update(us, move, value);
+        for (int i = 0; i < 2; ++i) {
+            if (contHist[i] != contHistory.sentinel()) contHist[i]->update(pc, move.to(), value);
+        }
+    };
 
-    Bitboard attackers = (diagonalAttacks & (attackingBishops | attackingQueens))
-                       | (orthogonalAttacks & (attackingRooks | attackingQueens))
-                       | (Attacks::get_knight_attacks(sq) & attackingKnights)
-                       | (Attacks::get_king_attacks(sq) & attackingKing)
-                       | (Attacks::get_pawn_attacks(~attackerColor, sq) & attackingPawns);
+    if (isNoisy(bestMove)) {
+        captureHistory.update(pos, bestMove, bonus);
+    } else {
+        updateQuiet(bestMove, bonus);
+        for (int i = 0; i < quietCount; ++i) updateQuiet(quiets[i], -bonus);
 
-    return attackers;
-}
-
-// Returns xrays attackers on sq (excluding knights/kings)
-Bitboard MoveOrderer::considerXRays(const Position& pos, Square sq, Bitboard occupiedBB) {
-    Bitboard attackingBishops = pos.bishops<White>() | pos.bishops<Black>();
-    Bitboard attackingRooks   = pos.rooks<White>() | pos.rooks<Black>();
-    Bitboard attackingQueens  = pos.queens<White>() | pos.queens<Black>();
+        if (prevMove.is_valid() && prevMove != NULL_MOVE) {
+            counterMoves.set(pos.pieceAt(prevMove.to()), prevMove.to(), bestMove);
+        }
+    }
 
-    Bitboard diagonalAttacks = Attacks::get_bishop_attacks(sq, occupiedBB);
-    Bitboard orthogonalAttacks = Attacks::get_rook_attacks(sq, occupiedBB);
+    // a capture that did not cut is worse than it looked, whatever cut instead
+    for (int i = 0; i < captureCount; ++i) captureHistory.update(pos, captures[i], -bonus);
+}
 
-    Bitboard attackers = (diagonalAttacks & (attackingBishops | attackingQueens))
-                       | (orthogonalAttacks & (attackingRooks | attackingQueens));
-    return attackers;
+template <Color c>
+MovePicker<c>::MovePicker(const Position& pos, MoveOrderer& orderer, Move ttMove, const Move killers[2],
+                          PieceToHistory* const contHist[2])
+    : pos(pos), orderer(orderer), ttMove(ttMove),
+      stage(ttMove.is_valid() ? TT_MOVE : INIT_CAPTURES) {
+    this->killers[0] = killers[0];
+    this->killers[1] = killers[1];
+    this->contHist[0] = contHist[0];
+    this->contHist[1] = contHist[1];
 }
 
-// Return all attackers on square sq by any side.
-Bitboard MoveOrderer::allAttackers(const Position& pos, Square sq, Bitboard occupiedBB) {
-    return attackersForSide(pos, White, sq, occupiedBB)
-         | attackersForSide(pos, Black, sq, occupiedBB);
+// killers come from sibling nodes: only quiet, legal ones are tried,
+// a noisy killer is searched in the capture stages anyway
+template <Color c>
+bool MovePicker<c>::usableKiller(Move move) const {
+    return move.is_valid() && move != ttMove && !isNoisy(move)
+        && pos.isPseudoLegal<c>(move) && pos.isLegal<c>(move);
 }
 
-// Find minimum value attacker bitboard and set attacker to its piece type.
-Bitboard MoveOrderer::minAttacker(const Position& pos, Bitboard attadef, Color color, PieceType& attacker) {
-    for (attacker = Pawn; attacker <= King; attacker = PieceType(attacker + 1)) {
-        Bitboard subset = attadef & pos.getPiecesBB(makepiece(color, attacker));
-        if (subset != 0) return (subset & -subset);  // Least significant bit
+template <Color c>
+void MovePicker<c>::pickBest(int end) {
+    int best = cur;
+    for (int i = cur + 1; i < end; ++i) {
+        if (moves[i].score > moves[best].score) best = i;
     }
-    return 0ULL;
+    if (best != cur) std::swap(moves[cur], moves[best]);
 }
 
-// Static Exchange Evaluation for a move.
-int MoveOrderer::see(const Position& pos, Move move) {
-    Square fromSq = move.from();
-    Square toSq = move.to();
-    PieceType target = piecetype(pos.pieceAt(toSq));
-    PieceType attacker = piecetype(pos.pieceAt(fromSq));
-    Color sideToMove = ~pos.sideToMove();
-
-    int gain[64] = {0};
-    int depth = 0;
-
-    Bitboard occupiedBB = pos.occupancy(White) | pos.occupancy(Black);
-    Bitboard attackerBB = SQUAREBB[fromSq];
+template <Color c>
+Move MovePicker<c>::next() {
+    switch (stage) {
+    case TT_MOVE:
+        stage = INIT_CAPTURES;
+        return ttMove;
 
-    Bitboard attadef = allAttackers(pos, toSq, occupiedBB);
-    Bitboard maxXray = occupiedBB & ~(pos.knights<White>() | pos.kings<White>() |
-                                      pos.knights<Black>() | pos.kings<Black>());
+    case INIT_CAPTURES: {
+        gen.generate<GenType::CAPTURES, c>(pos, moves);
+        endCaptures = static_cast<int>(moves.size());
 
-    gain[depth] = SEEVALUE[target];
-
-    while (attackerBB != 0) {
-        depth++;
-        if (depth >= 64) {
-            break;
-        }
-        gain[depth] = SEEVALUE[attacker] - gain[depth - 1];
-        if (std::max(-gain[depth - 1], gain[depth]) < 0)
-            break;
-
-        attadef &= ~attackerBB;
-        occupiedBB &= ~attackerBB;
-        if ((attackerBB & maxXray) != 0) {
-            attadef |= considerXRays(pos, toSq, occupiedBB);
+        for (int i = 0; i < endCaptures; ++i) {
+            moves[i].score = captureOrder(pos, orderer, moves[i]);
         }
-
-        attackerBB = minAttacker(pos, attadef, sideToMove, attacker);
-        sideToMove = ~sideToMove;
-    }
-
-    for (depth--; depth > 0; depth--) {
-        gain[depth - 1] = -std::max(-gain[depth - 1], gain[depth]);
+        stage = GOOD_CAPTURES;
+        [[fallthrough]];
     }
 
-    return gain[0];
-}
-
-// Quick check if SEE for move is >= threshold
-bool MoveOrderer::seeGe(const Position& pos, Move move, int threshold) {
-    Square fromSq = move.from();
-    Square toSq = move.to();
-
-    PieceType attackerType = piecetype(pos.pieceAt(fromSq));
-    PieceType capturedPiece = piecetype(pos.pieceAt(toSq));
-
-    bool isEnpassantMove = (attackerType == Pawn && toSq == pos.epSquare());
-    int toRank = rankof(toSq);
-    bool isPromotionMove = (attackerType == Pawn && (toRank == RANK_1 || toRank == RANK_8));
-
-    if (isPromotionMove)
-        return see(pos, move) >= threshold;
-
-    if (isEnpassantMove)
-        capturedPiece = Pawn;
-
-    if (capturedPiece == Nonetype && !isEnpassantMove)
-        return threshold <= 0;
-
-    int balance = SEEVALUE[capturedPiece] - threshold;
-    if (balance < 0)
-        return false;
-
-    balance -= SEEVALUE[attackerType];
-    if (balance >= 0)
-        return true;
-
-    return see(pos, move) >= threshold;
-}
-
-void MoveOrderer::scoreMoves(const Position& pos, MoveList& moves, Move ttMove, Move killers[2]) {
-   // std::cerr << "DEBUG: scoreMoves entered, moves.size=" << moves.size() << "\n";
-
-    scores.clear();
-    scores.resize(moves.size());
-    
-    for (size_t i = 0; i < moves.size(); i++) {
-        //std::cerr << "DEBUG: Scoring move " << i << "/" << moves.size() << "\n";
-
-        const Move& move = moves[i];
-        int score = 0;
-        
-        if (move.from() == ttMove.from() && move.to() == ttMove.to()) {
-            score = 100000;
-        } else if (move.from() == killers[0].from() && move.to() == killers[0].to()) {
-            score = 90000;
-        } else if (move.from() == killers[1].from() && move.to() == killers[1].to()) {
-            score = 80000;
-        } else if (move.is_capture()) {
-            //std::cerr << "DEBUG: Scoring move " << i << "/" << moves.size() << "\n";
-            score = see(pos, move) + 10000;
-            //std::cerr << "DEBUG: see returned score=" << score << "\n";
-        } else {
-            score = 0;
+    case GOOD_CAPTURES:
+        while (cur < endCaptures) {
+            pickBest(endCaptures);
+            Move move = moves[cur++];
+            if (move == ttMove) continue;
+            // SEE only for the capture that is about to be tried
+            if (see_ge(pos, move, 0)) return move;
+            moves[endBadCaptures++] = move;
         }
-        
-        scores[i] = score;
-    }
-    /*
-    std::sort(moves.begin(), moves.end(), [&](const Move& a, const Move& b) {
-        size_t i = &a - &moves[0];
-        size_t j = &b - &moves[0];
-        return scores[i] > scores[j];
-    });
-    */
-    
-    size_t n = moves.size();
-    for (size_t i = 0; i < n && i < 256; i++) {  // Add safety limit
-        size_t maxIdx = i;
-        for (size_t j = i + 1; j < n && j < 256; j++) {  // Add safety limit
-            if (scores[j] > scores[maxIdx]) {
-                maxIdx = j;
+        stage = KILLER_1;
+        [[fallthrough]];
+
+    case KILLER_1:
+        stage = KILLER_2;
+        if (!skipQuiets && usableKiller(killers[0])) return killers[0];
+        [[fallthrough]];
+
+    case KILLER_2:
+        stage = INIT_QUIETS;
+        if (!skipQuiets && killers[1] != killers[0] && usableKiller(killers[1])) return killers[1];
+        [[fallthrough]];
+
+    case INIT_QUIETS:
+        // quiets go behind the captures, the bad ones are still waiting there
+        if (!skipQuiets) {
+            gen.generate<GenType::QUIETS, c>(pos, moves);
+            endMoves = static_cast<int>(moves.size());
+            cur = endCaptures;
+            for (int i = endCaptures; i < endMoves; ++i) {
+                moves[i].score = orderer.quietHistory(pos, moves[i], contHist);
             }
         }
-        if (maxIdx != i) {
-            // Safe swap
-            Move tempMove = moves[i];
-            moves[i] = moves[maxIdx];
-            moves[maxIdx] = tempMove;
-            
-            int tempScore = scores[i];
-            scores[i] = scores[maxIdx];
-            scores[maxIdx] = tempScore;
-        }
-    }
-    
-    //std::cerr << "DEBUG: scoreMoves done\n";
-
-}
-
-void MoveOrderer::scoreCaptures(const Position& pos, MoveList& captures) {
-    scores.clear();
-    scores.resize(captures.size());
-    
-    for (size_t i = 0; i < captures.size(); i++) {
-        const Move& move = captures[i];
-        scores[i] = see(pos, move);
-    }
-    
-    // Sort captures by SEE value
-    for (size_t i = 0; i < captures.size(); i++) {
-        for (size_t j = i + 1; j < captures.size(); j++) {
-            if (scores[j] > scores[i]) {
-                std::swap(captures[i], captures[j]);
-                std::swap(scores[i], scores[j]);
-            }
+        stage = QUIETS;
+        [[fallthrough]];
+
+    case QUIETS:
+        while (!skipQuiets && cur < endMoves) {
+            pickBest(endMoves);
+            Move move = moves[cur++];
+            if (move != ttMove && !isKiller(move)) return move;
         }
+        cur = 0;
+        stage = BAD_CAPTURES;
+        [[fallthrough]];
+
+    case BAD_CAPTURES:
+        // already in capture order
+        if (cur < endBadCaptures) return moves[cur++];
+        stage = DONE;
+        [[fallthrough]];
+
+    case DONE:
+        break;
     }
+    return NO_MOVE;
 }
 
+template class MovePicker<White>;
+template class MovePicker<Black>;
@@ -3,30 +3,136 @@
 #include "../core/move.h"
 #include "../board/position.h"
 #include "../board/movegen.h"
+#include "../board/see.h"
+#include "history.h"
+#include "counter.h"
+#include <array>
 
+// captures and queen promotions are tried in the capture stages, the
+// same split as generate<CAPTURES> / generate<QUIETS>
+inline bool isNoisy(Move move) {
+    return move.is_capture() || move.flag() == QueenPromotion;
+}
+
+// ordering statistics of one search thread, the picker reads them
 class MoveOrderer {
 public:
-    MoveOrderer() = default;
+    MoveOrderer() { clear(); }
+
+    void clear();
+
+    // butterfly plus the continuation histories of the last two plies
+    int quietHistory(const Position& pos, Move move, PieceToHistory* const contHist[2]) const {
+        Piece pc = pos.pieceAt(move.from());
+        return mainHistory.get(pos.sideToMove(), move)
+             + contHist[0]->get(pc, move.to()) + contHist[1]->get(pc, move.to());
+    }
+
+    // bestMove cut the node off, the quiets and captures were searched
+    // before it without success, prevMove led to the node
+    void updateHistories(const Position& pos, Move bestMove, int depth,
+                         const Move* quiets, int quietCount,
+                         const Move* captures, int captureCount,
+                         PieceToHistory* const contHist[2], Move prevMove);
+
+    ButterflyHistory mainHistory;
+    CaptureHistory captureHistory;
+    CounterMoveTable counterMoves;
+    ContinuationHistory contHistory;
+};
+
+// ==================== CAPTURE ORDER ===========================
+// Most valuable victim first, least valuable attacker among equal victims.
+// The table is built by the compiler, victim Nonetype is a quiet queen
+// promotion which is ordered like winning a pawn.
+constexpr auto MVV_LVA = [] {
+    std::array<std::array<int16_t, 6>, 7> table{};
+    constexpr int victimValue[7] = { 1, 3, 3, 5, 9, 0, 1 };
+    for (int victim = Pawn; victim <= Nonetype; ++victim) {
+        for (int attacker = Pawn; attacker <= King; ++attacker) {
+            table[victim][attacker] = int16_t(victimValue[victim] * 64 + (King - attacker));
+        }
+    }
+    return table;
+}();
 
-    // Score quiet and non-capture moves for ordering
-    void scoreMoves(const Position& pos, MoveList& moves, Move ttMove, Move killers[2]);
+// promotions also win the difference to a pawn
+constexpr int PROMOTION_BONUS = 8 * 64;
 
-    // Score capture moves for ordering using SEE
-    void scoreCaptures(const Position& pos, MoveList& captures);
+inline int captureScore(const Position& pos, Move move) {
+    PieceType victim = (move.flag() == EnPassant) ? Pawn : piecetype(pos.pieceAt(move.to()));
+    int score = MVV_LVA[victim][piecetype(pos.pieceAt(move.from()))];
+    if (move.flag() == QueenPromotion || move.flag() == QueenPromoCapture) score += PROMOTION_BONUS;
+    return score;
+}
 
-    // Static Exchange Evaluation to order captures
-    int see(const Position& pos, Move move);
+// MVV-LVA decides, capture history only reorders close victims
+inline int captureOrder(const Position& pos, const MoveOrderer& orderer, Move move) {
+    return captureScore(pos, move) * 32 + orderer.captureHistory.get(pos, move) / 32;
+}
 
-    bool seeGe(const Position& pos, Move move, int threshold);
+// ==================== STAGED MOVE PICKER ===========================
+// Hands out the moves of a node one at a time, in the order the search
+// wants to try them:
+//
+//   tt move -> good captures -> killers -> quiets -> bad captures
+//
+// Captures are sorted by MVV-LVA and capture history, quiets by butterfly
+// and continuation history. Only the capture about to be returned is
+// checked by SEE, a losing one is set aside for the bad capture stage.
+// Nothing is generated before the tt move has been tried and a stage is
+// only scored once it is reached, so a node that cuts off early never
+// pays for the rest. Each stage picks its best remaining move with one
+// pass over the list instead of sorting it up front.
+// ============================================================================
+
+template <Color c>
+class MovePicker {
+public:
+    // ttMove must be NO_MOVE or legal in pos, contHist are the slices of
+    // the last two moves
+    MovePicker(const Position& pos, MoveOrderer& orderer, Move ttMove, const Move killers[2],
+               PieceToHistory* const contHist[2]);
+
+    // next legal move, NO_MOVE once every move was returned
+    Move next();
+
+    // the remaining quiets (killers included) are neither generated nor returned
+    void skipQuietMoves() { skipQuiets = true; }
 
-    // Storage for scores during sorting
-    std::vector<int> scores;
 private:
-    static constexpr int SEEVALUE[6] = {100, 300, 300, 500, 900, 50000};
+    enum Stage {
+        TT_MOVE,
+        INIT_CAPTURES,
+        GOOD_CAPTURES,
+        KILLER_1,
+        KILLER_2,
+        INIT_QUIETS,
+        QUIETS,
+        BAD_CAPTURES,
+        DONE
+    };
+
+    // swaps the best scored move of [cur, end) into cur
+    void pickBest(int end);
+    bool usableKiller(Move move) const;
+    bool isKiller(Move move) const { return move == killers[0] || move == killers[1]; }
+
+    const Position& pos;
+    MoveOrderer& orderer;
+    MoveGenerator gen;
 
-    Bitboard minAttacker(const Position& pos, Bitboard attadef, Color color, PieceType& attacker);
-    Bitboard considerXRays(const Position& pos, Square sq, Bitboard occupiedBB);
-    Bitboard allAttackers(const Position& pos, Square sq, Bitboard occupiedBB);
-    Bitboard attackersForSide(const Position& pos, Color attackerColor, Square sq, Bitboard occupiedBB);
+    Move ttMove;
+    Move killers[2];
+    PieceToHistory* contHist[2];
+    Stage stage;
+    bool skipQuiets = false;
 
-};
\ No newline at end of file
+    // captures first [0, endCaptures), quiets appended [endCaptures, endMoves),
+    // losing captures are moved down to [0, endBadCaptures) as they are found
+    MoveList moves;
+    int cur = 0;
+    int endBadCaptures = 0;
+    int endCaptures = 0;
+    int endMoves = 0;
+};
@@ -0,0 +1,66 @@
+#include "search.h"
+#include <algorithm>
+#include <cstdlib>
+
+namespace Search {
+
+// ==================== ASPIRATION WINDOWS ====================
+// From ASPIRATION_MIN_DEPTH on every iteration starts with a narrow window
+// around the previous score. A fail low or high widens the window on that
+// side by a growing delta and searches again. Fail highs also search one
+// ply shallower each time: the move is already known to be good and a
+// quick re-search finds out by how much.
+static constexpr int ASPIRATION_MIN_DEPTH = 4;
+static constexpr int ASPIRATION_DELTA = 25;
+
+// bound lines of the re-searches only once the search takes a while,
+// shallow iterations would flood the GUI with them
+static constexpr int64_t BOUND_INFO_MIN_TIME = 3000;    // ms
+
+int Searcher::aspiration_search(int depth, int prevScore) {
+    int delta = ASPIRATION_DELTA;
+    int alpha = -INFINITE;
+    int beta = INFINITE;
+
+    // mate scores swing too much for a window
+    if (depth >= ASPIRATION_MIN_DEPTH && std::abs(prevScore) < MATE_BOUND) {
+        alpha = std::max(prevScore - delta, -INFINITE);
+        beta = std::min(prevScore + delta, INFINITE);
+    }
+
+    int failHighs = 0;
+    while (true) {
+        int searchDepth = std::max(1, depth - failHighs);
+
+        stack[0].pv.clear();
+        int score = (pos.sideToMove() == White)
+            ? pvs<White, true>(searchDepth, 0, alpha, beta, false)
+            : pvs<Black, true>(searchDepth, 0, alpha, beta, false);
+
+        if (stopFlag) return score;
+
+        bool printBound = isMainThread() && tm.elapsed() > BOUND_INFO_MIN_TIME;
+
+        if (score <= alpha) {
+            // pull beta in as well, the true score is below the old window
+            beta = (alpha + beta) / 2;
+            alpha = std::max(score - delta, -INFINITE);
+            failHighs = 0;
+            if (printBound) update_uci_info(searchDepth, score, info.pv, HASH_FLAG_ALPHA);
+        }
+        else if (score >= beta) {
+            beta = std::min(score + delta, INFINITE);
+            failHighs++;
+            if (printBound) {
+                update_uci_info(searchDepth, score, stack[0].pv.length > 0 ? stack[0].pv : info.pv, HASH_FLAG_BETA);
+            }
+        }
+        else {
+            return score;
+        }
+
+        delta += delta / 2;
+    }
+}
+
+} // namespace Search
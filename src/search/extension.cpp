@@ -0,0 +1,26 @@
+#include "search.h"
+
+namespace Search {
+
+// ==================== EXTENSIONS ===========================
+// pvs asks for the extension of a move before making it:
+//
+// 1. singular extension of the tt move, which can also cut the node
+//    (multi-cut) or reduce the tt move (extensions/singular_ext.cpp)
+// 2. check extension (extensions/check_ext.cpp)
+// 3. recapture extension at pv nodes, below
+//
+// Only the first that applies counts, and nothing is extended past twice
+// the root depth so forced lines can not blow the search up.
+// ============================================================================
+
+// taking back on the square of the last capture keeps the material even,
+// the exchange has to be seen to its end
+int Searcher::recaptureExtension(Move move, int ply) {
+    Move previous = stack[ply - 1].currentMove;
+    if (!previous.is_capture() || !move.is_capture()) return 0;
+
+    return move.to() == previous.to() ? 1 : 0;
+}
+
+} // namespace Search
@@ -0,0 +1,16 @@
+#include "../search.h"
+
+namespace Search{
+
+    /**
+     * Check Extension
+     * a check forces the reply, so the line is searched one
+     * ply deeper. a check that simply hangs the checking piece
+     * is no forcing line and gets no extension
+     */
+    int Searcher::checkExtension(Move move,bool givesCheck){
+        if(!givesCheck) return 0;
+
+        return see_ge(pos,move,0) ? 1 : 0;
+    }
+}
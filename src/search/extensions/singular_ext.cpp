@@ -0,0 +1,67 @@
+#include "../search.h"
+#include <cstdlib>
+
+namespace Search{
+
+    /**
+     * Singular Extension
+     * if the tt says its move fails high and every other move
+     * fails low against a margin below the tt score, the tt move
+     * is the only move (singular) and is searched deeper.
+     *
+     * the test is a reduced search of the same node with the
+     * tt move excluded, its outcome also gives
+     *  - multi-cut: even without the tt move we beat beta,
+     *    more than one move cuts, so the node cuts
+     *  - negative extension: the tt move is not singular but
+     *    expected to cut anyway, search it shallower
+     */
+
+    constexpr int SINGULAR_DEPTH=7;
+    constexpr int SINGULAR_TT_DEPTH=3;        // tt entry at most this much shallower
+    constexpr int SINGULAR_MARGIN=2;          // per ply below the tt score
+    constexpr int DOUBLE_EXTENSION_MARGIN=20;
+    constexpr int MAX_DOUBLE_EXTENSIONS=6;    // per line
+
+    template <Color c>
+    bool Searcher::singularExtension(const TTData& tte,int depth,int ply,int beta,bool isPV,
+                                     bool cutNode,int& extension,int& score){
+        extension=0;
+
+        if(depth<SINGULAR_DEPTH) return false;
+        //needs a lower bound deep enough to trust
+        if(tte.flag==HASH_FLAG_ALPHA || tte.depth<depth-SINGULAR_TT_DEPTH) return false;
+        if(std::abs(tte.score)>=MATE_BOUND) return false;
+
+        int singularBeta=tte.score-SINGULAR_MARGIN*depth;
+        int singularDepth=(depth-1)/2;
+
+        stack[ply].excludedMove=tte.move;
+        int singularScore=pvs<c,false>(singularDepth,ply,singularBeta-1,singularBeta,cutNode);
+        stack[ply].excludedMove=NO_MOVE;
+
+        if(stopFlag) return false;
+
+        if(singularScore<singularBeta){
+            extension=1;
+            //far below, and the line has not been doubled too often yet
+            if(!isPV && singularScore<singularBeta-DOUBLE_EXTENSION_MARGIN
+               && stack[ply-1].doubleExtensions<MAX_DOUBLE_EXTENSIONS){
+                extension=2;
+            }
+        }
+        //multi-cut
+        else if(singularBeta>=beta){
+            score=singularBeta;
+            return true;
+        }
+        //the tt move cuts, but so may others
+        else if(tte.score>=beta){
+            extension=-1;
+        }
+        return false;
+    }
+
+    template bool Searcher::singularExtension<White>(const TTData&,int,int,int,bool,bool,int&,int&);
+    template bool Searcher::singularExtension<Black>(const TTData&,int,int,int,bool,bool,int&,int&);
+}
@@ -1,30 +1,61 @@
 #include "../search.h"
-/*
+#include <array>
+
 namespace Search{
 
     /**
      * Late Move Pruning(LMP)
-     * At shallow depth if w ehave search so many moves,
+     * At shallow depth if we have searched so many moves,
      * then we can skip remaining quiet move.
      */
-/*    template <Color c>
-    bool Searcher::shouldPruneMove(int depth,int moveCount,bool inCheck,
-                                   bool isCapture,bool isPromotion,bool givesCheck){
-        if(depth>4) return false;
-        if(inCheck) return false;
 
-        if(isCapture || isPromotion ||givesCheck) return false;
+    constexpr int LMP_DEPTH=8;
+
+    //after this many moves prune remaining quiet moves, by improving and depth
+    constexpr auto LMP_THRESHOLDS=[]{
+        std::array<std::array<int,LMP_DEPTH+1>,2> table{};
+        for(int depth=1;depth<=LMP_DEPTH;depth++){
+            table[0][depth]=(3+depth*depth)/2;
+            table[1][depth]=3+depth*depth;
+        }
+        return table;
+    }();
+
+    bool Searcher::shouldPruneMove(int depth,int moveCount,bool improving){
+        if(depth>LMP_DEPTH) return false;
+
+        return moveCount>=LMP_THRESHOLDS[improving][depth];
+    }
+
+    /**
+     * SEE Pruning
+     * near the leaves a move that loses material in the
+     * exchange on its target square is not worth a search,
+     * captures get a bigger allowance, they already won something
+     */
 
-        //after this many moves prune remaining quiet moves
-        const int LMP_THRESHOLDS[5]={0,3,6,12,20};
+    constexpr int SEE_QUIET_DEPTH=8;
+    constexpr int SEE_QUIET_MARGIN=50;      // per ply
+    constexpr int SEE_CAPTURE_DEPTH=6;
+    constexpr int SEE_CAPTURE_MARGIN=100;   // per ply
 
-        if (moveCount>LMP_THRESHOLDS[depth]){
-            return true;
+    bool Searcher::seePrunesMove(Move move,int depth,bool isQuiet){
+        if(isQuiet){
+            return depth<=SEE_QUIET_DEPTH && !see_ge(pos,move,-SEE_QUIET_MARGIN*depth);
         }
-        return false;
+        return depth<=SEE_CAPTURE_DEPTH && !see_ge(pos,move,-SEE_CAPTURE_MARGIN*depth);
     }
 
-    template bool Searcher::shouldPruneMove<White>(int,int,bool,bool,bool,bool);
-    template bool Searcher::shouldPruneMove<Black>(int,int,bool,bool,bool,bool);
+    /**
+     * History Pruning
+     * a quiet move that kept failing to cut elsewhere in the
+     * tree is unlikely to do it here, near the leaves it is skipped
+     */
+
+    constexpr int HISTORY_PRUNE_DEPTH=4;
+    constexpr int HISTORY_PRUNE_MARGIN=2048;    // per ply
+
+    bool Searcher::historyPrunesMove(int depth,int history){
+        return depth<=HISTORY_PRUNE_DEPTH && history< -HISTORY_PRUNE_MARGIN*depth;
+    }
 }
-*/
\ No newline at end of file
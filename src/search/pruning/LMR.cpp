@@ -1,81 +1,95 @@
 #include "../search.h"
 #include <algorithm>
-#include <cmath>
-/*
-namespace Search{
+#include <array>
 
-    //LMR PRECOMPUTED TABLES
-    static int LMRTable[64][64];  // depth,movecount
-    static bool LMRInitialized=false;
+namespace Search{
 
-    //initialized the LMR reduction table
-    void Searcher::initLMR(){
-        if(LMRInitialized) return;
+    /*****************************************************
+     *  Late Move Reductions(LMR)
+     *  moves late in a well ordered list rarely beat alpha
+     *  so they are searched with reduced depth first and
+     *  only searched again at full depth if they do
+     *****************************************************
+     */
+
+    // ln(x) = 2 atanh((x-1)/(x+1)), std::log is not constexpr
+    constexpr double constexprLog(double x){
+        double y=(x-1)/(x+1);
+        double y2=y*y;
+        double term=y;
+        double sum=0;
+        for(int k=1;k<200;k+=2){
+            sum+=term/k;
+            term*=y2;
+        }
+        return 2*sum;
+    }
 
-        for(int depth=1;depth<64;depth++){
-            for(int moveCount=1;moveCount<64;moveCount++){
-                double reduction=log(depth)*log(moveCount)/2.0;
-                LMRTable[depth][moveCount]=static_cast<int>(reduction);
+    //LMR PRECOMPUTED TABLE, built by the compiler
+    constexpr int LMR_SIZE=64;
+    constexpr auto LMRTable=[]{
+        std::array<std::array<int8_t,LMR_SIZE>,LMR_SIZE> table{};  // depth,movecount
+        for(int depth=1;depth<LMR_SIZE;depth++){
+            for(int moveCount=1;moveCount<LMR_SIZE;moveCount++){
+                double reduction=0.75+constexprLog(depth)*constexprLog(moveCount)/2.25;
+                table[depth][moveCount]=static_cast<int8_t>(reduction);
             }
         }
-        LMRInitialized=true;
-    }
+        return table;
+    }();
+
+    //history per ply of reduction, the table is bounded by HISTORY_MAX
+    constexpr int LMR_HISTORY_DIVISOR=8192;
+
+    static_assert(LMRTable[1][1]==0 && LMRTable[63][63]>LMRTable[8][8],"bad LMR table");
 
     //get LMR reduction ammount from precomputed table
-    int Searcher::getLMRReduction(int depth,int moveCount,bool isPV,bool improving){
-        if(!LMRInitialized){
-            initLMR();  //ensuring initialization
-        }
+    int Searcher::getLMRReduction(int depth,int moveCount,bool isPV,bool cutNode,
+                                  bool improving,bool givesCheck,bool isRefutation,int history){
+        int reduction=LMRTable[std::min(depth,LMR_SIZE-1)][std::min(moveCount,LMR_SIZE-1)];
 
-        if(depth>=64) depth = 63;
-        if(moveCount>=64) moveCount=63;
+        //pv nodes are worth a bit more depth
+        if(isPV) reduction--;
 
-        int reduction=LMRTable[depth][moveCount];
+        //expected cut nodes only need one move to fail high
+        if(cutNode) reduction++;
 
-        //adjust reduction based on node type
-        if(isPV){
-            //reduction=std::max(0,reduction-1);
-            return 0;
-        }
+        //reducing one more if not improving
+        if(!improving) reduction++;
 
-        //adjust based on improving
-        if(!improving){
-            reduction+=1; //reducing one more if not improving
-        }
+        //tactical quiet moves
+        if(givesCheck) reduction--;
+        if(isRefutation) reduction--;   //killers and the counter move
 
-        //is reduction is valid
-        reduction=std::max(0,reduction);
-        reduction=std::min(depth-1,reduction);
+        //quiets that cut off elsewhere get more depth, bad ones less
+        reduction-=history/LMR_HISTORY_DIVISOR;
 
-        return reduction;
+        //reduced search keeps at least one ply
+        return std::clamp(reduction,0,depth-2);
     }
 
-    //to check if move should removed or not
-    bool Searcher::shouldReduceMove(int depth,int legalMoves,bool inChcek,
+    //to check if move should reduced or not
+    bool Searcher::shouldReduceMove(int depth,int legalMoves,bool inCheck,
                           bool isCapture,bool isPromotion){
         if(depth<3){
             return false;
         }
 
-        if(legalMoves<=3){
+        //the first moves are the likely best ones
+        if(legalMoves<=2){
             return false;
         }
 
         //never reduce tactial moves
-        if(isCapture){
-            return false;
-        }
-
-        if(isPromotion){
+        if(isCapture || isPromotion){
             return false;
         }
 
-        //don`t reduce when in check
-        if(inChcek){
+        //don`t reduce when in check, every evasion matters
+        if(inCheck){
             return false;
         }
 
         return true;
     }
 }
-*/
\ No newline at end of file
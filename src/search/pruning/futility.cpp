@@ -1,9 +1,15 @@
 #include "../search.h"
-/*
+
 namespace Search{
 
+    /**
+     * Futility Pruning(FP)
+     * near the leaves a quiet move can not raise a static
+     * eval that is far below alpha, so it is not searched
+     */
+
     template <Color c>
-    bool Searcher::canFutilityPrune(int alpha,int depth,int staticEval,
+    bool Searcher::canFutilityPrune(int alpha,int depth,int staticEval,bool improving,
                                     bool isCapture,bool isPromotion,bool givesCheck){
         // condition to skip FP
         // only at shallow depth
@@ -13,10 +19,10 @@ namespace Search{
         if(isCapture||isPromotion||givesCheck) return false;
 
         //margin based on depth
-        const int FUTILITY_MARGINS[4]={0,150,300,500};
-        int margin=FUTILITY_MARGINS[depth];
+        constexpr int FUTILITY_MARGINS[4]={0,150,300,500};
+        int margin=FUTILITY_MARGINS[depth]+(improving ? 50 : 0);
 
-        //now check if eval beat beta +amrgin
+        //now check if eval plus margin still can`t reach alpha
         if(staticEval+margin<=alpha){
             return true;
         }
@@ -24,7 +30,6 @@ namespace Search{
     }
 
     //instantiations
-    template bool Searcher::canFutilityPrune<White>(int,int,int,bool,bool,bool);
-    template bool Searcher::canFutilityPrune<Black>(int,int,int,bool,bool,bool);
+    template bool Searcher::canFutilityPrune<White>(int,int,int,bool,bool,bool,bool);
+    template bool Searcher::canFutilityPrune<Black>(int,int,int,bool,bool,bool,bool);
 }
-*/
\ No newline at end of file
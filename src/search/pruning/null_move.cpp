@@ -1,77 +1,86 @@
 #include "../search.h"
-/*
+#include <algorithm>
+#include <cstdlib>
+
 namespace Search{
 
     /*****************************************************
      *  Null Move Pruning(NMP)
      *  so here the concept is if doing nothing(Null Move)
-     *  still give me a score>=beta then the position is 
-     *  so good that opponent never allow this move so we 
+     *  still give me a score>=beta then the position is
+     *  so good that opponent never allow this move so we
      *  prun this branch
+     *
+     *  in zugzwang doing nothing is the best move, so no
+     *  NMP without pieces and at high depth the cutoff is
+     *  verified by a reduced search without NMP
      *****************************************************
      */
-    /*
+
+    // verify cutoffs from this depth on
+    constexpr int NMP_VERIFICATION_DEPTH = 12;
+
     template <Color c>
-    bool Searcher::tryNullMove(int alpha,int beta,int depth,int ply,int& score){
+    bool Searcher::tryNullMove(int beta,int depth,int ply,int& score){
 
         //don`t do NMP at low depth
         if(depth<3) return false;
 
-        //don`t do NMP when in check
-        if(pos.inCheck<c>()) return false;
+        //don`t do NMP at root, or inside a verification search
+        if(ply==0 || ply<nmpMinPly) return false;
+
+        //two null moves in a row only skip a turn
+        if(stack[ply-1].currentMove==NULL_MOVE) return false;
 
-        //don`t do NMP at root
-        if(ply==0) return false;
+        //staticEval is NO_EVAL when in check
+        int staticEval=stack[ply].staticEval;
+        if(stack[ply].inCheck || staticEval<beta) return false;
 
+        //pawn endings are where zugzwang lives
         if(!pos.hasNonPawnMaterial<c>()) return false;
 
         //don`t do NMP near mate score
-        if(abs(beta)>MATE_SCORE-200) return false;
-
-        //only try NMP if we are ahead
-        int staticEval=eval.evaluate_board(pos);
-        if(staticEval<beta-100){
-            return false;
-        }
-
-        //calculate reduction
-        int R=2+depth/8;
+        if(std::abs(beta)>=MATE_BOUND) return false;
 
-        //increse R if beta is way good than eval
-        if(staticEval>=beta+200) R++;
-
-        if(depth-R-1<1){
-            R=depth-2;
-        }
+        //calculate reduction, more when eval is well above beta
+        int R=3+depth/3+std::min((staticEval-beta)/200,3);
 
         // ================= MAKE NULL MOVE ====================
-        Square savedEP=pos.epSquare();
-        uint8_t savedHalfMove=pos.getHalfMoveClock();
-        uint16_t savedFullMove=pos.getFullMoves();
-
+        stack[ply].currentMove=NULL_MOVE;
+        stack[ply].contHist=orderer.contHistory.sentinel();
         pos.makeNullMove<c>();
 
         //now search at reduced depth with null move
-        score = -pvs<~c,false>(depth-R-1,ply+1,-beta,-beta+1,false);
+        int nullScore = -pvs<~c,false>(depth-R,ply+1,-beta,-beta+1,false);
 
-        pos.unmakeNullMove<c>(savedEP,savedHalfMove,savedFullMove);
+        pos.unmakeNullMove<c>();
 
         //if search is stoped then can`t believe on the score
-        if(stopFlag){
+        if(stopFlag || nullScore<beta){
             return false;
         }
 
-        //now cutoff
-        if(score>=beta){
-            if(score>MATE_SCORE-MAX_PLY){
-                score=beta;
-            }
+        //unproven mates are not returned
+        if(nullScore>=MATE_BOUND) nullScore=beta;
+
+        if(depth<NMP_VERIFICATION_DEPTH || nmpMinPly){
+            score=nullScore;
+            return true;
+        }
+
+        //verification: same position, reduced depth, no NMP for the
+        //next plies of the subtree
+        nmpMinPly=ply+3*(depth-R)/4;
+        int verified=pvs<c,false>(depth-R,ply,beta-1,beta,false);
+        nmpMinPly=0;
+
+        if(verified>=beta){
+            score=nullScore;
             return true;
         }
         return false;  //here no cutoff
     }
 
-    template bool Searcher::tryNullMove<White>(int, int, int, int, int&);
-    template bool Searcher::tryNullMove<Black>(int, int, int, int, int&);
+    template bool Searcher::tryNullMove<White>(int, int, int, int&);
+    template bool Searcher::tryNullMove<Black>(int, int, int, int&);
 }
-*/
\ No newline at end of file
@@ -1,25 +1,34 @@
 #include "../search.h"
-/*
+#include <cstdlib>
+
 namespace Search{
 
+    /**
+     * Razoring
+     * if static eval is way below alpha at a frontier node
+     * only captures can save it, so ask quiescence and
+     * return if it confirms the fail low
+     */
+
+    constexpr int RAZOR_BASE=250;
+    constexpr int RAZOR_DEPTH=250;
+
     template <Color c>
     int Searcher::tryRazoring(int alpha,int depth,int ply){
         //so what are skip conditions
-        if(depth>3 || depth<0) return NO_RAZOR;
-        if(pos.inCheck<c>()) return NO_RAZOR;
+        if(depth>3 || depth<=0) return NO_RAZOR;
+        if(stack[ply].inCheck) return NO_RAZOR;
         if(ply==0) return NO_RAZOR;
 
         // Don't razor near mate scores
-        if(abs(alpha) > MATE_SCORE - 200) return NO_RAZOR;
+        if(std::abs(alpha)>=MATE_BOUND) return NO_RAZOR;
 
-        int staticEval=eval.evaluate_board(pos);
-        //margins
-        const int RAZOR_MARGINS[4]={0,200,300,450};
-        int margin=RAZOR_MARGINS[depth];
+        //margin grows fast with depth, a deeper search finds more than captures
+        int margin=RAZOR_BASE+RAZOR_DEPTH*depth*depth;
 
         //if static eval is way below than alpha then try qsearch
-        if(staticEval+margin<alpha){
-            int qScore=quiescence<c>(alpha-margin,alpha,ply);
+        if(stack[ply].staticEval+margin<alpha){
+            int qScore=quiescence<c>(alpha-1,alpha,ply);
             if(qScore<alpha){
                 return qScore;
             }
@@ -31,4 +40,3 @@ namespace Search{
     template int Searcher::tryRazoring<White>(int,int,int);
     template int Searcher::tryRazoring<Black>(int,int,int);
 }
-*/
\ No newline at end of file
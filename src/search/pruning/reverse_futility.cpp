@@ -1,46 +1,48 @@
 #include "../search.h"
-/*
+#include <cstdlib>
+
 namespace Search{
 
     /**
      * Reverse Futility Pruning(RFP)
      * if static Eval is way above the beta then,
      * our position is so good, that opponent never
-     * allow it,so return beta immediately.
+     * allow it,so return immediately.
      * 
      */
-    /*
+
+    constexpr int RFP_DEPTH=7;
+    constexpr int RFP_MARGIN=80;   // per ply, one ply less when improving
+
     template <Color c>
-    bool Searcher::tryReverseFutility(int beta,int depth,int ply,int& score){
+    bool Searcher::tryReverseFutility(int beta,int depth,int ply,bool improving,int& score){
         // condition to skip RFP
         // only at shallow depth
-        if(depth>7||depth<=0) return false;
+        if(depth>RFP_DEPTH||depth<=0) return false;
 
-        //don`t use when in check
-        if(pos.inCheck<c>()) return false;
+        //don`t use when in check, there is no static eval
+        if(stack[ply].inCheck) return false;
 
         //don`t use  at root
         if(ply==0) return false;
 
         //don`t use near mate score
-        if(abs(beta)>MATE_SCORE-200) return false;
+        if(std::abs(beta)>=MATE_BOUND) return false;
 
-        int staticEval=eval.evaluate_board(pos);
+        int staticEval=stack[ply].staticEval;
 
         //margin based on depth
-        const int RFP_MARGINS[8]={0,120,240,360,480,600,720,840};
-        int margin=RFP_MARGINS[depth];
+        int margin=RFP_MARGIN*(depth-improving);
 
         //now check if eval beat beta +amrgin
         if(staticEval-margin>=beta){
-            score=beta;
+            score=staticEval;
             return true;
         }
         return false;
     }
 
     //instantiations
-    template bool Searcher::tryReverseFutility<White>(int,int,int,int&);
-    template bool Searcher::tryReverseFutility<Black>(int,int,int,int&);
+    template bool Searcher::tryReverseFutility<White>(int,int,int,bool,int&);
+    template bool Searcher::tryReverseFutility<Black>(int,int,int,bool,int&);
 }
-*/
\ No newline at end of file
@@ -1,10 +1,21 @@
 #include "search.h"
+#include "thread.h"
 #include <iostream>
+#include <sstream>
+#include <thread>
 
 namespace Search {
 
-Searcher::Searcher(Position& pos, TranspositionTable& tt)
-    : pos(pos), tt(tt), stopFlag(false), nodes(0), selDepth(0) {
+// Lazy SMP depth staggering: helper i skips the depths where
+// ((depth + SkipPhase[i]) / SkipSize[i]) is odd, so at any moment the
+// helpers are spread over the next few iterations instead of racing the
+// main thread through the same one
+static constexpr int SKIP_TABLE_SIZE = 20;
+static constexpr int SkipSize[SKIP_TABLE_SIZE]  = { 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 4, 4, 4, 4, 4, 4, 4, 4 };
+static constexpr int SkipPhase[SKIP_TABLE_SIZE] = { 0, 1, 0, 1, 2, 3, 0, 1, 2, 3, 4, 5, 0, 1, 2, 3, 4, 5, 6, 7 };
+
+Searcher::Searcher(Position& pos, TranspositionTable& tt, ThreadPool& pool, size_t threadId)
+    : pos(pos), tt(tt), pool(pool), threadId(threadId), stopFlag(false), ponder(false), nodes(0), selDepth(0) {
     
     // Initialize stack
     for (int i = 0; i < MAX_PLY + 10; i++) {
@@ -16,13 +27,17 @@ Searcher::Searcher(Position& pos, TranspositionTable& tt)
 
 Move Searcher::think(const SearchLimits& limits) {
     this->limits = limits;
-    this->stopFlag = false;
     this->nodes = 0;
     this->info.clear();
     this->startTime = std::chrono::steady_clock::now();
     this->selDepth = 0;
+    this->nmpMinPly = 0;
 
-    tt.newSearch();
+    // helpers just search until the main thread stops them
+    if (!isMainThread()) {
+        iterative_deepening();
+        return info.pv.length > 0 ? info.pv.moves[0] : NO_MOVE;
+    }
 
     //calculate move number
     int fullMoves=pos.getFullMoves();
@@ -46,99 +61,91 @@ Move Searcher::think(const SearchLimits& limits) {
 
     iterative_deepening(); // main search loop
 
+    // with "go infinite" or while pondering the GUI has to ask for the
+    // move, hold bestmove until stop or ponderhit arrives
+    while (!stopFlag && (ponder || limits.infinite)) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    // main is done, helpers may be in the middle of an iteration
+    pool.stop();
+    pool.waitForHelpers();
+
+    const Searcher& best = pool.bestThread()->searcher;
+    if (&best != this) {
+        update_uci_info(best.info.depth, best.info.score, best.info.pv);
+    }
+
     Move bestMove = NO_MOVE;
-    if (info.pv.length > 0) {
-        bestMove = info.pv.moves[0];
+    if (best.info.pv.length > 0) {
+        bestMove = best.info.pv.moves[0];
     }
     
     bool moveInvalid = (bestMove.from() == bestMove.to()) || 
                        (bestMove.from() >= 64) || 
                        (bestMove.to() >= 64);
     
-    if (info.pv.length == 0 || moveInvalid) {
+    if (best.info.pv.length == 0 || moveInvalid) {
         std::cerr << "WARNING: Invalid PV move, generating emergency move" << std::endl;
         
-        // Generate emergency move
+        // Generate emergency move, every generated move is legal
         MoveList moves;
         if (pos.sideToMove() == White) {
             gen.generate_all_moves<White>(pos, moves);
-            
-            for (const Move& move : moves) {
-                pos.makemove<White>(move);
-                bool legal = !pos.inCheck<White>();
-                pos.unmakemove<White>(move);
-                
-                if (legal) {
-                    std::cerr << "Emergency move selected: " << move.to_uci_string() << std::endl;
-                    return move;
-                }
-            }
         } else {
             gen.generate_all_moves<Black>(pos, moves);
-            
-            for (const Move& move : moves) {
-                pos.makemove<Black>(move);
-                bool legal = !pos.inCheck<Black>();
-                pos.unmakemove<Black>(move);
-                
-                if (legal) {
-                    std::cerr << "Emergency move selected: " << move.to_uci_string() << std::endl;
-                    return move;
-                }
-            }
         }
-        
-        // Last resort: return first move if any exist
+
         if (!moves.empty()) {
-            std::cerr << "CRITICAL: Returning first pseudo-legal move!" << std::endl;
+            std::cerr << "Emergency move selected: " << moves[0].to_uci_string() << std::endl;
+            std::cout << ("bestmove " + moves[0].to_uci_string() + "\n");
             return moves[0];
         }
         
         std::cerr << "FATAL: No moves available!" << std::endl;
+        std::cout << "bestmove 0000\n";
         return NO_MOVE;
     }
     
+    // suggest the expected reply so the GUI can let us ponder on it
+    std::string line = "bestmove " + bestMove.to_uci_string();
+    if (best.info.pv.length > 1) {
+        line += " ponder " + best.info.pv.moves[1].to_uci_string();
+    }
+    std::cout << (line + "\n");
     return bestMove;
 }
 
 void Searcher::iterative_deepening() {
-    Move bestMoveFound = NO_MOVE;
-
     for (int depth = 1; depth <= limits.depth; ++depth) {
         if (stopFlag && depth>1) break;
-        stack[0].pv.clear();
-        int score;
-        if (pos.sideToMove() == White) {
-            score = pvs<White, true>(depth, 0, -INFINITE, INFINITE, false);
-        } else {
-            score = pvs<Black, true>(depth, 0, -INFINITE, INFINITE, false);
+
+        if (!isMainThread()) {
+            int i = (threadId - 1) % SKIP_TABLE_SIZE;
+            if (((depth + SkipPhase[i]) / SkipSize[i]) % 2) continue;
         }
+
+        rootDepth = depth;
+        int score = aspiration_search(depth, info.score);
         
         // check hard time
         if(depth>1){
-            check_time();
+            if (isMainThread()) check_time();
             if (stopFlag) break;
         }
 
         // Add bounds check before copying!
         if (stack[0].pv.length < MAX_PLY && stack[0].pv.length > 0) {
             info.pv = stack[0].pv;
-            bestMoveFound = stack[0].pv.moves[0];
         }
 
         info.depth = depth;
         info.score = score;
         info.nodes = nodes;
-        info.time = tm.elapsed();
-        info.nps = (info.time > 0) ? (1000ULL * nodes / info.time) : 0ULL;
-        update_uci_info(depth, score, info.pv);
-    }
 
-    // Output the saved best move
-    if (bestMoveFound.from() != bestMoveFound.to()) {
-        std::cout << "bestmove " << bestMoveFound.to_uci_string() << std::endl;
-    } else {
-        std::cout << "bestmove 0000" << std::endl;
+        if (isMainThread()) {
+            update_uci_info(depth, score, info.pv);
+        }
     }
 }
 
@@ -149,54 +156,146 @@ int Searcher::pvs(int depth, int ply, int alpha, int beta, bool cutNode) {
         return eval.evaluate_board(pos);
     }
 
+    // an early return must not leave a stale line for the parent to copy
+    stack[ply].pv.clear();
+
     if (depth <= 0) {
         return quiescence<c>(alpha, beta, ply);
     }
-    nodes++;
 
-    // Stop/time check every 2048 nodes
-    if ((nodes & 2047) == 0) check_time();
+    // Stop/time check every 2048 nodes, only the main thread watches the clock
+    if ((nodes.fetch_add(1, std::memory_order_relaxed) & 2047) == 2047 && isMainThread())
+        check_time();
     if (stopFlag) return 0;
+
+    // set while testing the tt move for singularity, the node is searched without it
+    Move excluded = stack[ply].excludedMove;
+    int oldAlpha = alpha;
+
     // Transposition Table probe
-    int ttScore;
-    Move ttMove;
-    if (tt.probe(pos.hash(), depth, alpha, beta, ttScore, ttMove, ply)){
-        return ttScore;
+    TTData tte;
+    bool ttHit = tt.probe(pos.hash(), tte, ply);
+    if (ttHit && tte.depth >= depth && excluded == NO_MOVE) {
+        if (tte.flag == HASH_FLAG_EXACT) return tte.score;
+        if (tte.flag == HASH_FLAG_ALPHA && tte.score <= alpha) return alpha;
+        if (tte.flag == HASH_FLAG_BETA && tte.score >= beta) return beta;
+    }
+    // the slot is only verified by 16 key bits, never trust its move blindly
+    Move ttMove = ttHit ? tte.move : NO_MOVE;
+    if (!pos.isPseudoLegal<c>(ttMove) || !pos.isLegal<c>(ttMove)) ttMove = NO_MOVE;
+
+    bool inCheck = pos.inCheck<c>();
+    stack[ply].inCheck = inCheck;
+    stack[ply].staticEval = inCheck ? NO_EVAL : static_eval(ttHit ? tte.eval : NO_EVAL);
+
+    // improving: eval above our last one, two plies up (four if that was in check)
+    int prevEval = ply >= 2 ? stack[ply - 2].staticEval : NO_EVAL;
+    if (prevEval == NO_EVAL && ply >= 4) prevEval = stack[ply - 4].staticEval;
+    bool improving = !inCheck && (prevEval == NO_EVAL || stack[ply].staticEval > prevEval);
+
+    // forward pruning, never in pv nodes
+    if (!PvNode && excluded == NO_MOVE) {
+        int rfpScore;
+        if (tryReverseFutility<c>(beta, depth, ply, improving, rfpScore)) return rfpScore;
+
+        int razorScore = tryRazoring<c>(alpha, depth, ply);
+        if (razorScore != NO_RAZOR) return razorScore;
+
+        int nullScore;
+        if (tryNullMove<c>(beta, depth, ply, nullScore)) return nullScore;
     }
-    // Move generation
-    MoveList moves;
-    gen.generate_all_moves<c>(pos, moves);
-    if (moves.empty())
-        return pos.inCheck<c>() ? -MATE_SCORE + ply : 0;
 
-    orderer.scoreMoves(pos, moves, ttMove, stack[ply].killers);
+    // the moves that led here, the sentinel stands in above the root
+    PieceToHistory* contHist[2] = {
+        ply >= 1 ? stack[ply - 1].contHist : orderer.contHistory.sentinel(),
+        ply >= 2 ? stack[ply - 2].contHist : orderer.contHistory.sentinel()
+    };
+    Move prevMove = ply >= 1 ? stack[ply - 1].currentMove : NO_MOVE;
+    Move counterMove = (prevMove.is_valid() && prevMove != NULL_MOVE)
+                     ? orderer.counterMoves.get(pos.pieceAt(prevMove.to()), prevMove.to()) : NO_MOVE;
+
+    // moves are generated and scored lazily, stage by stage
+    MovePicker<c> picker(pos, orderer, ttMove, stack[ply].killers, contHist);
 
     Move bestMove = NO_MOVE;
     int bestScore = -INFINITE;
     int legalMoves = 0;
-    
-    for (const Move move : moves) {
-        pos.makemove<c>(move);
 
-         if (pos.inCheck<c>()) {
-            pos.unmakemove<c>(move);
-            continue;
+    // moves that were searched without a cutoff, punished by the one that cuts
+    Move quietsTried[64], capturesTried[32];
+    int quietCount = 0, captureCount = 0;
+
+    Move move;
+    while ((move = picker.next()).is_valid()) {
+        if (move == excluded) continue;
+
+        bool givesCheck = pos.givesCheck<c>(move);
+        bool isQuiet = !move.is_capture() && !move.is_promotion();
+        int history = isQuiet ? orderer.quietHistory(pos, move, contHist) : 0;
+
+        // shallow depth pruning once one move was searched and we are not mated
+        if (ply > 0 && legalMoves > 0 && !inCheck && bestScore > -MATE_BOUND && !givesCheck) {
+            if (isQuiet) {
+                // late move pruning, the remaining quiets are not even generated
+                if (shouldPruneMove(depth, legalMoves, improving)) {
+                    picker.skipQuietMoves();
+                    continue;
+                }
+                if (!PvNode && canFutilityPrune<c>(alpha, depth, stack[ply].staticEval, improving,
+                                                   false, false, false)) {
+                    continue;
+                }
+                if (!PvNode && historyPrunesMove(depth, history)) continue;
+            }
+            if (seePrunesMove(move, depth, isQuiet)) continue;
+        }
+
+        // extensions (extension.cpp), the first that applies counts
+        int extension = 0;
+        if (ply > 0 && ply < 2 * rootDepth) {
+            if (move == ttMove && excluded == NO_MOVE) {
+                int singularScore;
+                if (singularExtension<c>(tte, depth, ply, beta, PvNode, cutNode, extension, singularScore)) {
+                    return singularScore;   // multi-cut
+                }
+            }
+            if (extension == 0) extension = checkExtension(move, givesCheck);
+            if (extension == 0 && PvNode) extension = recaptureExtension(move, ply);
         }
+        stack[ply].doubleExtensions = (ply > 0 ? stack[ply - 1].doubleExtensions : 0) + (extension >= 2);
+        int newDepth = depth - 1 + extension;
 
+        stack[ply].currentMove = move;
+        pos.makemove<c>(move);
+        stack[ply].contHist = orderer.contHistory.slice(pos.pieceAt(move.to()), move.to());
         legalMoves++;
 
         int score;
         if (legalMoves==1) {
-            score = -pvs<~c, PvNode>(depth - 1, ply + 1, -beta, -alpha, false);
+            score = -pvs<~c, PvNode>(newDepth, ply + 1, -beta, -alpha, false);
         } else {
-            score = -pvs<~c, false>(depth - 1, ply + 1, -alpha - 1, -alpha, true);
+            // late move reductions, a reduced move beating alpha is searched again
+            int R = 0;
+            if (shouldReduceMove(depth, legalMoves, inCheck, move.is_capture(), move.is_promotion())) {
+                bool isRefutation = move == stack[ply].killers[0] || move == stack[ply].killers[1]
+                                 || move == counterMove;
+                R = getLMRReduction(depth, legalMoves, PvNode, cutNode, improving, givesCheck, isRefutation, history);
+            }
+            score = -pvs<~c, false>(newDepth - R, ply + 1, -alpha - 1, -alpha, true);
+            if (score > alpha && R > 0) {
+                score = -pvs<~c, false>(newDepth, ply + 1, -alpha - 1, -alpha, !cutNode);
+            }
             if (score > alpha && score < beta){
-                score = -pvs<~c, PvNode>(depth - 1, ply + 1, -beta, -alpha, false);
+                score = -pvs<~c, PvNode>(newDepth, ply + 1, -beta, -alpha, false);
             }
         }
 
         pos.unmakemove<c>(move);
 
+        // an interrupted search returns garbage, nothing of it may reach
+        // the tt, the killers or the histories
+        if (stopFlag) return 0;
+
         if (score > bestScore) {
             bestScore = score;
             bestMove = move;
@@ -211,49 +310,88 @@ int Searcher::pvs(int depth, int ply, int alpha, int beta, bool cutNode) {
                         stack[ply].killers[1] = stack[ply].killers[0];
                         stack[ply].killers[0] = move;
                     }
+                    orderer.updateHistories(pos, move, depth, quietsTried, quietCount,
+                                            capturesTried, captureCount, contHist, prevMove);
                     break; // beta cutoff
                 }
             }
         }
+
+        if (!isNoisy(move)) {
+            if (quietCount < 64) quietsTried[quietCount++] = move;
+        } else if (captureCount < 32) {
+            capturesTried[captureCount++] = move;
+        }
     }
 
     if (legalMoves == 0) {
-        return pos.inCheck<c>() ? (-MATE_SCORE + ply) : 0;
+        // without the excluded move nothing is left, that says nothing about the node
+        if (excluded != NO_MOVE) return alpha;
+        return inCheck ? (-MATE_SCORE + ply) : 0;
     }
 
-    // Store to TT
-    int flag = (bestScore >= beta) ? HASH_FLAG_BETA :
-                (bestScore > alpha) ? HASH_FLAG_EXACT :
-                                      HASH_FLAG_ALPHA;
-    tt.store(pos.hash(), depth, flag, bestScore, 0, ply, bestMove);
+    // Store to TT, a search without the excluded move is not this node's result
+    if (excluded == NO_MOVE) {
+        int flag = (bestScore >= beta) ? HASH_FLAG_BETA :
+                   (bestScore > oldAlpha) ? HASH_FLAG_EXACT :
+                                            HASH_FLAG_ALPHA;
+        tt.store(pos.hash(), depth, flag, bestScore, stack[ply].staticEval, ply, bestMove);
+    }
 
     return bestScore;
 }
 
 
+// values for qsearch futility, indexed by the captured piece type
+static constexpr int QS_PIECE_VALUE[7] = { 100, 320, 330, 500, 950, 0, 0 };
+static constexpr int QS_FUTILITY_MARGIN = 150;
+
 template <Color c>
-int Searcher::quiescence(int alpha, int beta, int ply) {
+int Searcher::quiescence(int alpha, int beta, int ply, int depth) {
     // Hard limit to prevent infinite recursion
     if (ply >= MAX_PLY-1) {
         return eval.evaluate_board(pos);
     }
 
-    nodes++;
-    
     // Check time periodically
-    if ((nodes & 2047) == 0) {
+    if ((nodes.fetch_add(1, std::memory_order_relaxed) & 2047) == 2047 && isMainThread()) {
         check_time();
     }
     if (stopFlag) return 0;
 
+    // Draw detection, before the tt can answer for a repeated position
+    if (pos.isDrawByFiftyMove() || pos.isDrawByRepetition(ply)) {
+        return 0;
+    }
+
     bool inCheck = pos.inCheck<c>();
-    
+    bool pvNode = beta - alpha > 1;
+    int oldAlpha = alpha;
+
+    // Transposition Table probe, qsearch entries only cut other qsearch nodes
+    int ttDepth = (inCheck || depth >= 0) ? QS_DEPTH_CHECKS : QS_DEPTH_NO_CHECKS;
+    TTData tte;
+    bool ttHit = tt.probe(pos.hash(), tte, ply);
+    if (!pvNode && ttHit && tte.depth >= ttDepth) {
+        if (tte.flag == HASH_FLAG_EXACT) return tte.score;
+        if (tte.flag == HASH_FLAG_ALPHA && tte.score <= alpha) return alpha;
+        if (tte.flag == HASH_FLAG_BETA && tte.score >= beta) return beta;
+    }
+
     // Stand pat (only if not in check)
     int standPat = 0;
+    int staticEval = NO_EVAL;
     if (!inCheck) {
-        standPat = eval.evaluate_board(pos);
-        
+        staticEval = standPat = static_eval(ttHit ? tte.eval : NO_EVAL);
+
+        // a tt bound on the right side is a better guess than the eval
+        if (ttHit && ((tte.flag == HASH_FLAG_BETA && tte.score > standPat) ||
+                      (tte.flag == HASH_FLAG_ALPHA && tte.score < standPat))) {
+            standPat = tte.score;
+        }
+
         if (standPat >= beta) {
+            if (!ttHit) tt.store(pos.hash(), ttDepth, HASH_FLAG_BETA, standPat, staticEval, ply, NO_MOVE);
             return beta;
         }
         
@@ -268,98 +406,126 @@ int Searcher::quiescence(int alpha, int beta, int ply) {
         }
     }
 
+    // out of check only captures and queen promotions are interesting,
+    // plus quiet checks on the first qsearch ply, in check every evasion is
     MoveList movelist;
-    gen.generate_all_moves<c>(pos, movelist);
-    if (movelist.empty()) {
-        return inCheck ? (-MATE_SCORE + ply) : 0;
+    if (inCheck) {
+        gen.generate<EVASIONS, c>(pos, movelist);
+        if (movelist.empty()) {
+            return -MATE_SCORE + ply;
+        }
+    } else {
+        gen.generate<CAPTURES, c>(pos, movelist);
+        if (depth >= QS_DEPTH_CHECKS) gen.generate<QUIET_CHECKS, c>(pos, movelist);
     }
 
-    // Draw detection
-    if (pos.isDrawByFiftyMove() || pos.isDrawByRepetition(ply)) {
-        return 0;
+    // the tt move goes first, then captures by MVV-LVA, then quiet checks
+    Move ttMove = ttHit ? tte.move : NO_MOVE;
+    for (ExtMove& m : movelist) {
+        m.score = (m == ttMove) ? INFINITE
+                : (m.is_capture() || m.is_promotion()) ? captureOrder(pos, orderer, m) : -1;
     }
 
-    MoveList interestingMoves;
-    interestingMoves.reserve(movelist.size());
+    // Search all interesting moves
+    Move bestMove = NO_MOVE;
+    for (size_t i = 0; i < movelist.size(); ++i) {
+        // one selection pass per move, a cutoff leaves the rest unsorted
+        size_t best = i;
+        for (size_t j = i + 1; j < movelist.size(); ++j) {
+            if (movelist[j].score > movelist[best].score) best = j;
+        }
+        std::swap(movelist[i], movelist[best]);
+        const Move move = movelist[i];
+
+        // every evasion is searched, out of check hopeless moves are not
+        if (!inCheck) {
+            bool givesCheck = pos.givesCheck<c>(move);
 
-    if (inCheck) {
-       interestingMoves = movelist;
-    } else {
-        for (const auto& move : movelist) {
-            if(move.is_capture()){
-                interestingMoves.push_back(move);
-            }
-            else if (move.is_promotion()){
-                interestingMoves.push_back(move);
+            // futility: even winning the captured piece does not reach alpha
+            if (!givesCheck && !move.is_promotion()) {
+                PieceType captured = (move.flag() == EnPassant) ? Pawn : piecetype(pos.pieceAt(move.to()));
+                if (standPat + QS_FUTILITY_MARGIN + QS_PIECE_VALUE[captured] <= alpha) continue;
             }
-        }
-    }
 
-    // If no tactical moves and not in check, return stand pat
-    if (!inCheck && interestingMoves.empty()) {
-        return alpha;
-    }
+            // the exchange on the target square loses material
+            if (!see_ge(pos, move, 0)) continue;
+        }
 
-        // Search all interesting moves
-    int legalMoves = 0;
-    for (const Move& move : interestingMoves) {
         // Make the move
         pos.makemove<c>(move);
-        
-        // CRITICAL: Check if move is legal (doesn't leave king in check)
-        if (pos.inCheck<c>()) {
-            pos.unmakemove<c>(move);
-            continue;
-        }
-        
-        legalMoves++;
 
         // Recursive quiescence search with negamax framework
-        int score = -quiescence<~c>(-beta, -alpha, ply + 1);
+        int score = -quiescence<~c>(-beta, -alpha, ply + 1, depth - 1);
         
         // Unmake the move
         pos.unmakemove<c>(move);
 
+        if (stopFlag) return 0;
+
         // Beta cutoff
         if (score >= beta) {
+            tt.store(pos.hash(), ttDepth, HASH_FLAG_BETA, score, staticEval, ply, move);
             return beta;
         }
         
         // Update alpha
         if (score > alpha) {
             alpha = score;
+            bestMove = move;
         }
     }
 
-    // If in check and no legal moves found, it's checkmate
-    if (inCheck && legalMoves == 0) {
-        return -MATE_SCORE + ply;
-    }
-
+    tt.store(pos.hash(), ttDepth, alpha > oldAlpha ? HASH_FLAG_EXACT : HASH_FLAG_ALPHA,
+             alpha, staticEval, ply, bestMove);
     return alpha;
 }
 void Searcher::check_time() {
     //checks if hardTime exceeded
     tm.Check();
 
-    //stops when hard time reached
-    if (tm.StopFlag()){
+    //stops when hard time reached, pondering ignores the clock
+    if (tm.StopFlag() && !ponder){
         stopFlag = true;
     }
 }
 
-void Searcher::update_uci_info(int depth, int score, const PVLine& pv) {
-    std::cout << "info depth " << depth
-              << " score cp " << score
-              << " nodes " << nodes
-              << " nps " << info.nps
-              << " time " << info.time
-              << " pv ";
+void Searcher::update_uci_info(int depth, int score, const PVLine& pv, int bound) {
+    // node counts cover every thread of the pool
+    uint64_t totalNodes = pool.nodesSearched();
+    int64_t time = tm.elapsed();
+    uint64_t nps = (time > 0) ? (1000ULL * totalNodes / time) : 0ULL;
+
+    // build the whole line first, the input thread may print readyok
+    // while we search and single writes do not interleave
+    std::ostringstream ss;
+    ss << "info depth " << depth
+       << " score cp " << score;
+    if (bound == HASH_FLAG_BETA) ss << " lowerbound";
+    else if (bound == HASH_FLAG_ALPHA) ss << " upperbound";
+    ss << " nodes " << totalNodes
+       << " nps " << nps
+       << " time " << time
+       << " pv ";
     int maxMoves = std::min(pv.length, MAX_PLY);
     for (int i = 0; i < maxMoves; i++){
-        std::cout << pv.moves[i].to_uci_string() << " ";
+        ss << pv.moves[i].to_uci_string() << " ";
     }
-    std::cout << std::endl;
+    ss << "\n";
+    std::cout << ss.str();
+}
+
+int Searcher::static_eval(int ttEval) {
+    // the tt and the cache hold what evaluate_board returned before
+    if (ttEval != NO_EVAL) {
+        return ttEval;
+    }
+    int value;
+    if (evalCache.probe(pos.hash(), value)) {
+        return value;
+    }
+    value = eval.evaluate_board(pos);
+    evalCache.store(pos.hash(), value);
+    return value;
 }
 
 bool Searcher::is_draw(int ply) const {
@@ -370,10 +536,17 @@ void Searcher::newGame() {
     nodes = 0;
     selDepth = 0;
     stopFlag = false;
+    evalCache.clear();
+    orderer.clear();
     for (int i = 0; i < MAX_PLY + 10; i++) {
         stack[i].clear();
     }
 }
 
-};
+// entry points for aspiration.cpp and pruning/
+template int Searcher::pvs<White, true>(int depth, int ply, int alpha, int beta, bool cutNode);
+template int Searcher::pvs<Black, true>(int depth, int ply, int alpha, int beta, bool cutNode);
+template int Searcher::pvs<White, false>(int depth, int ply, int alpha, int beta, bool cutNode);
+template int Searcher::pvs<Black, false>(int depth, int ply, int alpha, int beta, bool cutNode);
 
+};
@@ -2,7 +2,9 @@
 
 #include "../board/position.h"
 #include "../board/movegen.h"
+#include "../board/see.h"
 #include "../table/tt.h"
+#include "../table/eval_cache.h"
 #include "../ordering/ordering.h"
 #include "../evaluation/evaluation.h"
 #include "timemanager.h"
@@ -23,24 +25,37 @@ using ASTROVE::eval::Evaluator;
 //    at each increasing depth.
 // 3. Uses quiescence() at leaf nodes for tactical stability (avoiding
 //    horizon effects).
-// 4. Orders moves efficiently using the MoveOrderer for better pruning.
+// 4. Orders moves with a staged MovePicker (tt move, captures, killers,
+//    quiets) for better pruning.
 // 5. Uses the Transposition Table (TT) to skip already-explored positions.
 // 6. Checks stop/time flags periodically to stay responsive under UCI control.
 // 7. Sends UCI “info” updates (depth, score, PV) for GUI feedback.
 // 8. Returns the best move found after the time or depth limit is reached.
 //
+// One Searcher runs per thread of the ThreadPool (thread.h). They share only
+// the TT, the main thread (id 0) owns the clock and reports the best move.
+//
 // ============================================================================
 
 namespace Search {
 
 // constants
 constexpr int MAX_PLY = 256;
-constexpr int INFINITE = 50000;
-constexpr int MATE_SCORE = 49000;
-constexpr int TB_WIN_SCORE = 48000;
+// scores must fit the int16 fields of a TTEntry
+constexpr int INFINITE = 32001;
+constexpr int MATE_SCORE = 32000;
+constexpr int TB_WIN_SCORE = 30000;
 constexpr int MATE_BOUND = MATE_SCORE - MAX_PLY;
+constexpr int NO_EVAL = NO_HASH_ENTRY;  // static eval of a node in check
+constexpr int NO_RAZOR = INFINITE + 1;  // tryRazoring did not cut
+// tt depths of quiescence entries: first qsearch ply (or in check), deeper
+constexpr int QS_DEPTH_CHECKS = 0;
+constexpr int QS_DEPTH_NO_CHECKS = -1;
+static_assert(MATE_BOUND > TT_MATE_BOUND && TB_WIN_SCORE < TT_MATE_BOUND,
+              "mate scores must be recognised by the transposition table");
 
 // Forward declarations
+class ThreadPool;
 struct SearchLimits;
 struct PVLine;
 struct SearchStack;
@@ -69,6 +84,7 @@ struct PVLine {
 // store data for a ply 
 struct SearchStack {
     Move currentMove = NO_MOVE;
+    PieceToHistory* contHist = nullptr;   // continuation slice of currentMove
     Move excludedMove = NO_MOVE;
     Move killers[2] = {NO_MOVE, NO_MOVE};
     int staticEval = 0;
@@ -83,6 +99,7 @@ struct SearchStack {
 
     void clear() {
         currentMove = excludedMove = NO_MOVE;
+        contHist = nullptr;
         killers[0] = NO_MOVE;
         killers[1] = NO_MOVE;
         staticEval = moveCount = doubleExtensions = 0;
@@ -136,16 +153,25 @@ struct SearchInfo {
 
 class Searcher {
 public:
-    // constructor
-    explicit Searcher(Position& pos, TranspositionTable& tt);
+    // constructor, threadId 0 is the main thread of the pool
+    Searcher(Position& pos, TranspositionTable& tt, ThreadPool& pool, size_t threadId);
 
     // start search with given limits and return best move found
+    // on the main thread this also coordinates the helpers and prints bestmove
     Move think(const SearchLimits& limits);
 
     void stop() { stopFlag = true; }
+    void resetStop() { stopFlag = false; }
+    // while pondering the clock is not ours, ponderhit hands it back
+    void setPonder(bool p) { ponder = p; }
+    void ponderhit() { ponder = false; }
     //reset the internal state for a new game
     void newGame();
 
+    bool isMainThread() const { return threadId == 0; }
+    uint64_t nodesSearched() const { return nodes.load(std::memory_order_relaxed); }
+    const SearchInfo& searchInfo() const { return info; }
+
 private:
     // --- search algorithm ---
     //negamax with alpha-beta pruning and PV node
@@ -154,16 +180,22 @@ private:
 
     //extend search at leaf of tree for avoiding horizon effect
     template <Color Us>
-    int quiescence(int alpha, int beta, int ply);
+    int quiescence(int alpha, int beta, int ply, int depth = 0);
 
     // main search loop
     void iterative_deepening();
 
+    //root search of one iteration with a window around prevScore (aspiration.cpp)
+    int aspiration_search(int depth, int prevScore);
+
     //checks search should be stop due to time constrint
     void check_time();
 
-    //update uci info for uci output
-    void update_uci_info(int depth, int score, const PVLine& pv);
+    //update uci info for uci output, bound is a HASH_FLAG for fail high/low lines
+    void update_uci_info(int depth, int score, const PVLine& pv, int bound = HASH_FLAG_EXACT);
+
+    //static eval: the tt's if known (else NO_EVAL), the eval cache's or the evaluator's
+    int static_eval(int ttEval);
 
     //functions for draw(for repetition,50-move rule)
     bool is_draw(int ply) const;
@@ -173,42 +205,55 @@ private:
 
     // Null Move Pruning
     template <Color c>
-    bool tryNullMove(int alpha,int beta,int depth,int ply,int& score);
+    bool tryNullMove(int beta,int depth,int ply,int& score);
 
     template <Color c>
-    bool tryReverseFutility(int beta, int depth, int ply, int& score);
+    bool tryReverseFutility(int beta, int depth, int ply, bool improving, int& score);
 
-    template <Color c>
-    bool shouldPruneMove(int depth,int moveCount,bool inCheck,
-                                     bool isCapture,bool isPromotion,bool givesCheck);
+    bool shouldPruneMove(int depth,int moveCount,bool improving);
+    bool seePrunesMove(Move move,int depth,bool isQuiet);
+    bool historyPrunesMove(int depth,int history);
     
     template <Color c>
     int tryRazoring(int alpha, int depth, int ply);
 
     template <Color c>
-    bool canFutilityPrune(int alpha,int depth,int staticEval,
+    bool canFutilityPrune(int alpha,int depth,int staticEval,bool improving,
                                       bool isCapture,bool isPromotion,bool givesCheck);
     
-    void initLMR();
-    int getLMRReduction(int depth, int moveCount, bool isPV, bool improving);
+    // Extensions
+    template <Color c>
+    bool singularExtension(const TTData& tte, int depth, int ply, int beta, bool isPV,
+                           bool cutNode, int& extension, int& score);
+    int checkExtension(Move move, bool givesCheck);
+    int recaptureExtension(Move move, int ply);
+
+    int getLMRReduction(int depth, int moveCount, bool isPV, bool cutNode,
+                        bool improving, bool givesCheck, bool isRefutation, int history);
     bool shouldReduceMove(int depth, int legalMoves, bool inCheck,
                           bool isCapture, bool isPromotion);
     // --- DATA MEMBERS ---
     Position& pos;
     TranspositionTable& tt;
+    ThreadPool& pool;
+    size_t threadId;
 
     Evaluator eval;
+    EvalCache evalCache;
     MoveGenerator gen;
     TimeManager tm;
     MoveOrderer orderer;
 
     // Search state
     std::atomic<bool> stopFlag;
+    std::atomic<bool> ponder;
     SearchLimits limits; //current search constraint
     SearchInfo info; //current search statistics
     std::chrono::steady_clock::time_point startTime;
-    uint64_t nodes;
+    std::atomic<uint64_t> nodes; // read by the main thread for uci output
     int selDepth; 
+    int nmpMinPly = 0; // no null moves before this ply while verifying one
+    int rootDepth = 0; // depth of the current iteration
 
     // per ply data for deep search
     SearchStack stack[MAX_PLY + 10];
@@ -0,0 +1,129 @@
+#include "thread.h"
+
+namespace Search {
+
+// nativeThread is the last member, so the worker only starts once
+// the searcher it runs is fully constructed
+Thread::Thread(size_t id, TranspositionTable& tt, ThreadPool& pool)
+    : id(id), rootPos(), searcher(rootPos, tt, pool, id),
+      nativeThread(&Thread::idleLoop, this) {
+    waitForSearchFinished();
+}
+
+Thread::~Thread() {
+    exit = true;
+    startSearching();
+    nativeThread.join();
+}
+
+void Thread::startSearching() {
+    std::lock_guard<std::mutex> lock(mutex);
+    searching = true;
+    cv.notify_one();
+}
+
+void Thread::waitForSearchFinished() {
+    std::unique_lock<std::mutex> lock(mutex);
+    cv.wait(lock, [&] { return !searching; });
+}
+
+void Thread::idleLoop() {
+    while (true) {
+        std::unique_lock<std::mutex> lock(mutex);
+        searching = false;
+        cv.notify_one(); // wake anyone waiting for search finished
+        cv.wait(lock, [&] { return searching; });
+
+        if (exit) return;
+
+        lock.unlock();
+        searcher.think(limits);
+    }
+}
+
+
+ThreadPool::~ThreadPool() {
+    for (Thread* th : threads) delete th;
+}
+
+void ThreadPool::set(size_t n, TranspositionTable& tt) {
+    if (!threads.empty()) {
+        main()->waitForSearchFinished();
+        for (Thread* th : threads) delete th;
+        threads.clear();
+    }
+
+    for (size_t i = 0; i < n; ++i) {
+        threads.push_back(new Thread(i, tt, *this));
+    }
+}
+
+void ThreadPool::startThinking(const Position& pos, const SearchLimits& limits,
+                               TranspositionTable& tt) {
+    main()->waitForSearchFinished();
+
+    tt.newSearch();
+
+    for (Thread* th : threads) {
+        th->rootPos = pos;
+        th->limits = limits;
+        th->searcher.resetStop();
+        th->searcher.setPonder(limits.ponder);
+    }
+
+    // helpers first: by the time main can finish and wait for them
+    // they are all flagged as searching
+    for (size_t i = threads.size(); i-- > 0; ) {
+        threads[i]->startSearching();
+    }
+}
+
+void ThreadPool::stop() {
+    for (Thread* th : threads) th->searcher.stop();
+}
+
+void ThreadPool::ponderhit() {
+    main()->searcher.ponderhit();
+}
+
+void ThreadPool::waitForSearchFinished() {
+    main()->waitForSearchFinished();
+}
+
+void ThreadPool::waitForHelpers() {
+    for (size_t i = 1; i < threads.size(); ++i) {
+        threads[i]->waitForSearchFinished();
+    }
+}
+
+void ThreadPool::newGame() {
+    main()->waitForSearchFinished();
+    for (Thread* th : threads) th->searcher.newGame();
+}
+
+uint64_t ThreadPool::nodesSearched() const {
+    uint64_t total = 0;
+    for (const Thread* th : threads) total += th->searcher.nodesSearched();
+    return total;
+}
+
+Thread* ThreadPool::bestThread() const {
+    Thread* best = main();
+
+    for (Thread* th : threads) {
+        const SearchInfo& cand = th->searcher.searchInfo();
+        const SearchInfo& cur = best->searcher.searchInfo();
+        if (cand.pv.length == 0) continue;
+
+        // a deeper iteration wins unless it scores worse, at equal depth
+        // the higher score wins
+        if ((cand.depth > cur.depth && cand.score >= cur.score)
+            || (cand.depth == cur.depth && cand.score > cur.score)
+            || cur.pv.length == 0) {
+            best = th;
+        }
+    }
+    return best;
+}
+
+} // namespace Search
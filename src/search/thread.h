@@ -0,0 +1,77 @@
+#pragma once
+
+#include "search.h"
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// ==================== LAZY SMP ===========================
+// Every worker owns a full Searcher: its own root Position copy, search
+// stack, evaluator and move ordering tables. The only thing the workers
+// share is the transposition table, which is how they help each other.
+//
+// Worker 0 is the main thread: it runs the time manager, prints UCI
+// output, and once it is done it stops the helpers and reports the best
+// move of whichever thread finished with the most trustworthy result.
+// Threads are created once and sleep between "go" commands.
+// ============================================================================
+
+namespace Search {
+
+class Thread {
+public:
+    Thread(size_t id, TranspositionTable& tt, ThreadPool& pool);
+    ~Thread();
+
+    // wakes the worker, it runs searcher.think(limits) on rootPos
+    void startSearching();
+    void waitForSearchFinished();
+
+    size_t id;
+    Position rootPos;
+    SearchLimits limits;
+    Searcher searcher;
+
+private:
+    void idleLoop();
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool exit = false;
+    bool searching = true;   // true until the worker reached idleLoop
+    std::thread nativeThread;
+};
+
+class ThreadPool {
+public:
+    ThreadPool() = default;
+    ~ThreadPool();
+
+    // (re)creates n workers sharing tt, waits for a running search first
+    void set(size_t n, TranspositionTable& tt);
+
+    // copies pos to every worker and wakes them all, returns at once:
+    // the main worker is the search thread, the caller keeps reading input
+    void startThinking(const Position& pos, const SearchLimits& limits, TranspositionTable& tt);
+
+    void stop();
+    // the opponent played the expected move, switch to normal time control
+    void ponderhit();
+    void waitForSearchFinished();
+    void waitForHelpers();
+    void newGame();
+
+    uint64_t nodesSearched() const;
+
+    // thread whose last completed iteration is deepest/best scoring
+    Thread* bestThread() const;
+
+    Thread* main() const { return threads.front(); }
+    size_t size() const { return threads.size(); }
+
+private:
+    std::vector<Thread*> threads;
+};
+
+} // namespace Search
@@ -0,0 +1,6 @@
+#include "eval_cache.h"
+#include <algorithm>
+
+void EvalCache::clear() {
+    std::fill(entries.begin(), entries.end(), 0);
+}
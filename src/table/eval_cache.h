@@ -0,0 +1,35 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// ==================== EVAL CACHE ===========================
+// Static evaluations of positions the TT could not provide one for.
+// A slot is a single 64 bit word, the upper 48 key bits and the 16 bit
+// score, so it is read and written in one access and never needs a lock.
+// Each Searcher owns one.
+// ============================================================================
+
+class EvalCache {
+public:
+    static constexpr size_t SIZE = 1 << 16;    // slots, 512 KB
+
+    EvalCache() : entries(SIZE, 0) {}
+
+    bool probe(uint64_t key, int& eval) const {
+        uint64_t data = entries[key & (SIZE - 1)];
+        if ((data ^ key) >> 16) return false;
+        eval = static_cast<int16_t>(data & 0xFFFF);
+        return true;
+    }
+
+    void store(uint64_t key, int eval) {
+        entries[key & (SIZE - 1)] = (key & ~0xFFFFULL) | static_cast<uint16_t>(eval);
+    }
+
+    // needed whenever the evaluation function changes
+    void clear();
+
+private:
+    std::vector<uint64_t> entries;
+};
@@ -0,0 +1,6 @@
+#include "material_cache.h"
+#include <algorithm>
+
+void MaterialTable::clear() {
+    std::fill(entries.begin(), entries.end(), MaterialEntry{});
+}
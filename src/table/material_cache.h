@@ -0,0 +1,47 @@
+#pragma once
+#include "../core/types.h"
+#include "../evaluation/psqt.h"
+#include <cstdint>
+#include <vector>
+
+class Position;
+
+// ==================== MATERIAL HASH TABLE ===========================
+// Everything that only depends on which pieces are left (game phase,
+// imbalance, scaling of drawish endings, a specialised endgame evaluator)
+// is computed once per material key and cached here. Like the pawn table
+// every Evaluator owns one, so there is no sharing between threads.
+// ============================================================================
+
+constexpr int SCALE_FACTOR_DRAW = 0;
+constexpr int SCALE_FACTOR_NORMAL = 64;
+
+// side to move relative score of a known endgame
+using EndgameFn = int (*)(const Position& pos);
+
+struct MaterialEntry {
+    uint64_t key = 0;
+    int phase = 0;                          // clamped to 0..24
+    ASTROVE::EvalScore imbalance = 0;       // white minus black
+
+    // out of SCALE_FACTOR_NORMAL, applied to the endgame part when that
+    // colour is the one ahead
+    uint8_t scaleFactor[2] = {SCALE_FACTOR_NORMAL, SCALE_FACTOR_NORMAL};
+
+    // replaces the whole evaluation when set
+    EndgameFn endgame = nullptr;
+};
+
+class MaterialTable {
+public:
+    static constexpr size_t SIZE = 1 << 13;    // entries, power of two
+
+    MaterialTable() : entries(SIZE) {}
+
+    // slot of the key, the caller fills it when the stored key differs
+    MaterialEntry* probe(uint64_t key) { return &entries[key & (SIZE - 1)]; }
+    void clear();
+
+private:
+    std::vector<MaterialEntry> entries;
+};
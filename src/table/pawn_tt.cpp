@@ -0,0 +1,6 @@
+#include "pawn_tt.h"
+#include <algorithm>
+
+void PawnTable::clear() {
+    std::fill(entries.begin(), entries.end(), PawnEntry{});
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include "../core/types.h"
+#include "../evaluation/psqt.h"
+#include <cstdint>
+#include <vector>
+
+// ==================== PAWN HASH TABLE ===========================
+// Pawns rarely move during a search, so everything that depends only on
+// them is computed once per pawn key and cached here. Every Evaluator,
+// and so every search thread, owns its own table: no locks, no races.
+// ============================================================================
+
+// A default entry is valid for a position without pawns (key 0), so an
+// empty slot can be hit without being filled first.
+struct PawnEntry {
+    uint64_t key = 0;
+    ASTROVE::EvalScore score = 0;           // structure terms, white minus black
+
+    Bitboard passed[2] = {};                // passed pawns
+    Bitboard attacks[2] = {};               // squares attacked by pawns
+    Bitboard attackSpans[2] = {};           // squares pawns may attack after advancing
+    uint8_t semiOpenFiles[2] = {0xFF, 0xFF};  // one bit per file without own pawns
+
+    // also depends on the king square, filled when evaluation asks for it
+    Square kingSquare[2] = {NO_SQ, NO_SQ};
+    ASTROVE::EvalScore kingShelter[2] = {};
+};
+
+class PawnTable {
+public:
+    static constexpr size_t SIZE = 1 << 14;    // entries, power of two
+
+    PawnTable() : entries(SIZE) {}
+
+    // slot of the key, the caller fills it when the stored key differs
+    PawnEntry* probe(uint64_t key) { return &entries[key & (SIZE - 1)]; }
+    void clear();
+
+private:
+    std::vector<PawnEntry> entries;
+};
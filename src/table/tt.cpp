@@ -1,8 +1,10 @@
 #include "tt.h"
 #include <cstring>
 #include <cstdlib>
+#include <algorithm>
+#include <climits>
 
-TranspositionTable::TranspositionTable() : table(nullptr), numEntries(0), currentAge(0) {}
+TranspositionTable::TranspositionTable() : table(nullptr), numClusters(0), currentAge(0) {}
 
 TranspositionTable::~TranspositionTable() {
     if (table) {
@@ -13,7 +15,8 @@ TranspositionTable::~TranspositionTable() {
 // clear all tt entries
 void TranspositionTable::clear() {
     if (!table) return;
-    std::memset(table, 0, numEntries * sizeof(TTEntry));
+    std::memset(static_cast<void*>(table), 0, numClusters * sizeof(TTCluster));
+    currentAge = 0;
 }
 
 
@@ -22,30 +25,37 @@ void TranspositionTable::init(size_t sizeMB) {
     if (sizeMB < 1) sizeMB = 1;
 
     size_t bytes = sizeMB * 1024ULL * 1024ULL;
-    numEntries = bytes / sizeof(TTEntry);
-    if (numEntries == 0) {
+    size_t clusters = bytes / sizeof(TTCluster);
+    if (clusters == 0) {
         std::cerr << "Failed TT allocation.\n";
         throw std::bad_alloc();
     }
 
+    if (table) {
+        ::operator delete[](table, std::align_val_t(64));
+        table = nullptr;
+        numClusters = 0;
+    }
+
     try {
-        table = static_cast<TTEntry*>(
-            ::operator new[](numEntries * sizeof(TTEntry), std::align_val_t(64))
+        table = static_cast<TTCluster*>(
+            ::operator new[](clusters * sizeof(TTCluster), std::align_val_t(64))
         );
     } catch (const std::bad_alloc&) {
         std::cerr << "FATAL: TT allocation failed for " << sizeMB << " MB.\n";
         throw;
     }
+    numClusters = clusters;
 
     clear();
     std::cout << "info string TT initialized: " << sizeMB
-              << " MB (" << numEntries << " entries)\n";
+              << " MB (" << numClusters * CLUSTER_SIZE << " entries)\n";
 }
 
 
 // begin a new search and increment age (for aging policy)
 void TranspositionTable::newSearch() {
-    currentAge = (currentAge + 1) & 0xFF;
+    currentAge = (currentAge + 1) & AGE_MASK;
 }
 
 
@@ -53,76 +63,100 @@ void TranspositionTable::newSearch() {
 void TranspositionTable::store(uint64_t key, int depth, int flag,
                                int score, int eval, int ply, Move bestMove) {
 
-    size_t index = key % (numEntries / MAX_BUCKETS);
-    TTEntry* bucket = &table[index * MAX_BUCKETS];
+    TTCluster* cluster = clusterFor(key);
+    const uint16_t key16 = static_cast<uint16_t>(key);
 
     // normalize mate score for storage
-    if (score >= 49000) score += ply;
-    else if (score <= -49000) score -= ply;
-
-    // replacement scheme prefer deeper or newer entrie
-    TTEntry* replace = &bucket[0];
-    for (int i = 0; i < MAX_BUCKETS; ++i) {
-        if (bucket[i].key == key) { replace = &bucket[i]; break; }
-        if (bucket[i].depth < replace->depth || bucket[i].age != currentAge)
-            replace = &bucket[i];
+    if (score >= TT_MATE_BOUND) score += ply;
+    else if (score <= -TT_MATE_BOUND) score -= ply;
+
+    // replacement scheme: same position or empty slot first, otherwise
+    // the entry with the lowest depth, penalized by how old it is
+    int slot = 0;
+    TTEntry replace;
+    int replaceValue = INT32_MAX;
+    bool sameKey = false;
+    for (int i = 0; i < CLUSTER_SIZE; ++i) {
+        uint64_t data = cluster->data[i].load(std::memory_order_relaxed);
+        uint16_t check = cluster->check[i].load(std::memory_order_relaxed);
+        TTEntry entry = TTEntry::unpack(data);
+
+        if (entry.empty() || slotKey(data, check) == key16) {
+            slot = i;
+            replace = entry;
+            sameKey = !entry.empty();
+            break;
+        }
+        int value = entry.depth8 - 8 * relativeAge(entry);
+        if (value < replaceValue) {
+            slot = i;
+            replace = entry;
+            replaceValue = value;
+        }
     }
 
-    replace->key   = key;
-    replace->depth = static_cast<int8_t>(depth);
-    replace->flag  = static_cast<uint8_t>(flag);
-    replace->score = static_cast<int16_t>(score);
-    replace->eval  = static_cast<int16_t>(eval);
-    replace->age   = static_cast<uint8_t>(currentAge);
-    replace->bestMove = bestMove;
+    // do not let a shallow bound of the same position wipe out deeper data
+    if (sameKey && flag != HASH_FLAG_EXACT
+        && depth - DEPTH_OFFSET + 4 <= replace.depth8
+        && relativeAge(replace) == 0)
+        return;
+
+    TTEntry entry;
+    // keep the old move if this search did not produce one
+    entry.bestMove  = (bestMove.is_valid() || !sameKey) ? bestMove : replace.bestMove;
+    entry.score     = static_cast<int16_t>(score);
+    entry.eval      = static_cast<int16_t>(eval);
+    entry.depth8    = static_cast<uint8_t>(std::clamp(depth - DEPTH_OFFSET, 1, 255));
+    entry.genBound8 = static_cast<uint8_t>((currentAge << 2) | flag);
+
+    uint64_t data = entry.pack();
+    cluster->data[slot].store(data, std::memory_order_relaxed);
+    cluster->check[slot].store(static_cast<uint16_t>(key16 ^ fold(data)), std::memory_order_relaxed);
 }
 
 
 // probe for a position in the tt
-bool TranspositionTable::probe(uint64_t key, int depth, int alpha,
-                               int beta, int& score, Move& bestMove, int ply) const {
+bool TranspositionTable::probe(uint64_t key, TTData& out, int ply) const {
 
-    size_t index = key % (numEntries / MAX_BUCKETS);
-    TTEntry* bucket = &table[index * MAX_BUCKETS];
+    const TTCluster* cluster = clusterFor(key);
+    const uint16_t key16 = static_cast<uint16_t>(key);
 
-    for (int i = 0; i < MAX_BUCKETS; ++i) {
-        const TTEntry& entry = bucket[i];
-        if (entry.key != key) continue;
+    for (int i = 0; i < CLUSTER_SIZE; ++i) {
+        uint64_t data = cluster->data[i].load(std::memory_order_relaxed);
+        uint16_t check = cluster->check[i].load(std::memory_order_relaxed);
+        if (slotKey(data, check) != key16) continue;
 
-        bestMove = entry.bestMove;
-        if (entry.depth < depth) return false;
+        TTEntry entry = TTEntry::unpack(data);
+        if (entry.empty()) continue;
 
         int stored = entry.score;
-        if (stored >= 49000) stored -= ply;
-        else if (stored <= -49000) stored += ply;
-
-        if (entry.flag == HASH_FLAG_EXACT) {
-            score = stored;
-            return true;
-        }
-        if (entry.flag == HASH_FLAG_ALPHA && stored <= alpha) {
-            score = alpha;
-            return true;
-        }
-        if (entry.flag == HASH_FLAG_BETA && stored >= beta) {
-            score = beta;
-            return true;
-        }
+        if (stored >= TT_MATE_BOUND) stored -= ply;
+        else if (stored <= -TT_MATE_BOUND) stored += ply;
+
+        out.move  = entry.bestMove;
+        out.score = stored;
+        out.eval  = entry.eval;
+        out.depth = entry.depth();
+        out.flag  = entry.flag();
+        return true;
     }
     return false;
 }
 
 
-// calculate hash table fill ratio
+// calculate hash table fill ratio (permille of entries written by this search)
 int TranspositionTable::hashfull() const {
-    if (!table || numEntries==0) return 0;
+    if (!table || numClusters == 0) return 0;
     int cnt = 0;
 
-    int sampled = std::min(1000, static_cast<int>(numEntries));
-    
+    int sampled = std::min(1000, static_cast<int>(numClusters));
+
     for (int i = 0; i < sampled; ++i) {
-        if (table[i].key != 0) cnt++;
+        for (int j = 0; j < CLUSTER_SIZE; ++j) {
+            TTEntry entry = TTEntry::unpack(table[i].data[j].load(std::memory_order_relaxed));
+            if (!entry.empty() && entry.age() == currentAge) cnt++;
+        }
     }
-    
-    return (cnt * 1000) / sampled;
+
+    return (cnt * 1000) / (sampled * CLUSTER_SIZE);
 }
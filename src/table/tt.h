@@ -1,5 +1,6 @@
 #pragma once
 #include "../core/move.h"
+#include <atomic>
 #include <cstdint>
 #include <cstdlib>
 #include <iostream>
@@ -9,21 +10,74 @@
 constexpr int HASH_FLAG_EXACT = 0;
 constexpr int HASH_FLAG_ALPHA = 1;
 constexpr int HASH_FLAG_BETA  = 2;
-constexpr int NO_HASH_ENTRY   = 32002;
+constexpr int NO_HASH_ENTRY   = 32002;  // also marks a missing static eval
 
-constexpr int MAX_BUCKETS = 2; // number of tt entrie per index
+constexpr int CLUSTER_SIZE = 6;     // number of tt entries sharing one cache line
+constexpr int DEPTH_OFFSET = -8;    // stored depth is depth-DEPTH_OFFSET so qsearch depths fit in a byte
+constexpr int TT_MATE_BOUND = 31000; // scores beyond this are mate scores and stored relative to the node
 
+constexpr int AGE_BITS  = 6;        // generation counter packed above the 2 bound bits
+constexpr int AGE_CYCLE = 1 << AGE_BITS;
+constexpr int AGE_MASK  = AGE_CYCLE - 1;
 
-struct alignas(64) TTEntry {
-    uint64_t key;       // zobrist key of the position
+
+// Decoded view of one slot. In the table the fields live in a single
+// 64 bit word so a slot is always written and read with one access:
+//   bits  0-15 best move      bits 32-47 static eval
+//   bits 16-31 score          bits 48-55 depth8, 56-63 genBound8
+struct TTEntry {
+    Move bestMove;      // best move found
     int16_t score;      // stored search score
     int16_t eval;       // static evaluation
-    uint8_t depth;      // search depth of entry
-    uint8_t flag;       // alpha / beta / exact
-    uint8_t age;        // for replacement policy
-    uint8_t padding;    // alignment to 8 bytes
-    Move bestMove;      // best move found
+    uint8_t depth8;     // depth - DEPTH_OFFSET, 0 marks an empty slot
+    uint8_t genBound8;  // age (upper 6 bits) | flag (lower 2 bits)
+
+    int depth() const { return int(depth8) + DEPTH_OFFSET; }
+    int flag() const { return genBound8 & 0x3; }
+    uint8_t age() const { return genBound8 >> 2; }
+    bool empty() const { return depth8 == 0; }
+
+    uint64_t pack() const {
+        return  uint64_t(bestMove.raw())
+             | (uint64_t(uint16_t(score)) << 16)
+             | (uint64_t(uint16_t(eval))  << 32)
+             | (uint64_t(depth8)          << 48)
+             | (uint64_t(genBound8)       << 56);
+    }
+
+    static TTEntry unpack(uint64_t data) {
+        TTEntry e;
+        e.bestMove  = Move(static_cast<MoveData>(data));
+        e.score     = static_cast<int16_t>(data >> 16);
+        e.eval      = static_cast<int16_t>(data >> 32);
+        e.depth8    = static_cast<uint8_t>(data >> 48);
+        e.genBound8 = static_cast<uint8_t>(data >> 56);
+        return e;
+    }
+};
+
+// What a probe hit hands to the search, the score is already relative to
+// the probing ply
+struct TTData {
+    Move move = NO_MOVE;
+    int score = NO_HASH_ENTRY;
+    int eval = NO_HASH_ENTRY;
+    int depth = 0;
+    int flag = HASH_FLAG_ALPHA;
+};
+
+// Six slots fill exactly one 64 byte cache line. Every slot is a data
+// word plus a 16 bit check word holding key16 ^ fold(data); the two are
+// written with separate relaxed stores, so a slot torn by two threads
+// writing concurrently fails verification instead of returning a mix
+// of both positions. No locks are taken on probe or store.
+struct alignas(64) TTCluster {
+    std::atomic<uint64_t> data[CLUSTER_SIZE];
+    std::atomic<uint16_t> check[CLUSTER_SIZE];
+    char padding[64 - CLUSTER_SIZE * (sizeof(uint64_t) + sizeof(uint16_t))];
 };
+static_assert(sizeof(TTCluster) == 64, "TTCluster must be one cache line");
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "TT needs lock free 64 bit atomics");
 
 // ----------------------------------------------------------
 // Transposition Table Class
@@ -40,13 +94,34 @@ public:
     void store(uint64_t key, int depth, int flag,
                int score, int eval, int ply, Move bestMove);
 
-    bool probe(uint64_t key, int depth, int alpha,
-               int beta, int& score, Move& bestMove, int ply) const;
+    // fills data and returns true on a hit, cutoffs are up to the caller.
+    // the move comes from a 16 bit verified slot and may belong to another
+    // position, callers must check it with Position::isPseudoLegal
+    bool probe(uint64_t key, TTData& data, int ply) const;
 
     int hashfull() const;                        // occupancy (for UCI display)
 
 private:
-    TTEntry* table = nullptr;
-    size_t numEntries = 0;
+    TTCluster* table = nullptr;
+    size_t numClusters = 0;
     uint8_t currentAge = 0;
+
+    // maps the key onto [0, numClusters) using the high bits of key*numClusters
+    TTCluster* clusterFor(uint64_t key) const {
+        return &table[(static_cast<__uint128_t>(key) * numClusters) >> 64];
+    }
+
+    static uint16_t fold(uint64_t data) {
+        return static_cast<uint16_t>(data ^ (data >> 16) ^ (data >> 32) ^ (data >> 48));
+    }
+
+    // key16 of the slot, derived from the check word; a torn slot yields garbage
+    static uint16_t slotKey(uint64_t data, uint16_t check) {
+        return static_cast<uint16_t>(check ^ fold(data));
+    }
+
+    // age distance from the current search, wraps around AGE_CYCLE
+    int relativeAge(const TTEntry& entry) const {
+        return (AGE_CYCLE + currentAge - entry.age()) & AGE_MASK;
+    }
 };
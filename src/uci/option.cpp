@@ -0,0 +1,83 @@
+#include "options.h"
+#include <algorithm>
+#include <cctype>
+#include <iostream>
+#include <sstream>
+
+namespace UCIOptions {
+
+Option::Option(int def, int min, int max, OnChange f)
+    : type("spin"), defaultValue(std::to_string(def)), currentValue(defaultValue),
+      min(min), max(max), onChange(std::move(f)) {}
+
+Option::Option(bool def, OnChange f)
+    : type("check"), defaultValue(def ? "true" : "false"), currentValue(defaultValue),
+      onChange(std::move(f)) {}
+
+Option::Option(const char* def, OnChange f)
+    : type("string"), defaultValue(def), currentValue(defaultValue),
+      onChange(std::move(f)) {}
+
+bool Option::set(const std::string& value) {
+    if (type == "spin") {
+        int v;
+        try {
+            v = std::stoi(value);
+        } catch (...) {
+            return false;
+        }
+        if (v < min || v > max) return false;
+        currentValue = std::to_string(v);
+    }
+    else if (type == "check") {
+        if (value != "true" && value != "false") return false;
+        currentValue = value;
+    }
+    else {
+        currentValue = value;
+    }
+
+    if (onChange) onChange(*this);
+    return true;
+}
+
+void Option::print(std::ostream& os, const std::string& name) const {
+    os << "option name " << name << " type " << type << " default " << defaultValue;
+    if (type == "spin") os << " min " << min << " max " << max;
+    os << "\n";
+}
+
+bool CaseInsensitiveLess::operator()(const std::string& a, const std::string& b) const {
+    return std::lexicographical_compare(a.begin(), a.end(), b.begin(), b.end(),
+        [](unsigned char x, unsigned char y) { return std::tolower(x) < std::tolower(y); });
+}
+
+void OptionsMap::add(const std::string& name, const Option& option) {
+    options[name] = option;
+}
+
+void OptionsMap::setoption(std::istream& is) {
+    std::string token, name, value;
+
+    is >> token; // "name"
+    // option names may contain spaces, read until "value"
+    while (is >> token && token != "value")
+        name += (name.empty() ? "" : " ") + token;
+    while (is >> token)
+        value += (value.empty() ? "" : " ") + token;
+
+    auto it = options.find(name);
+    if (it == options.end()) {
+        std::cout << "info string No such option: " << name << "\n";
+        return;
+    }
+    if (!it->second.set(value))
+        std::cout << "info string Invalid value for " << name << ": " << value << "\n";
+}
+
+void OptionsMap::print(std::ostream& os) const {
+    for (const auto& [name, option] : options)
+        option.print(os, name);
+}
+
+} // namespace UCIOptions
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <functional>
+#include <map>
+#include <ostream>
+#include <string>
+
+// ==================== UCI OPTIONS ===========================
+// Every option the engine exposes through "setoption" lives in one
+// OptionsMap owned by the UCI handler. Options print themselves for the
+// "uci" command and call their onChange hook when the GUI changes them.
+// ============================================================================
+
+namespace UCIOptions {
+
+class Option {
+public:
+    using OnChange = std::function<void(const Option&)>;
+
+    Option() = default;
+    Option(int def, int min, int max, OnChange f = nullptr);   // spin
+    Option(bool def, OnChange f = nullptr);                     // check
+    Option(const char* def, OnChange f = nullptr);              // string
+
+    // returns false (and keeps the old value) if value is out of range
+    bool set(const std::string& value);
+
+    int asInt() const { return std::stoi(currentValue); }
+    bool asBool() const { return currentValue == "true"; }
+    const std::string& asString() const { return currentValue; }
+
+    void print(std::ostream& os, const std::string& name) const;
+
+private:
+    std::string type;
+    std::string defaultValue;
+    std::string currentValue;
+    int min = 0;
+    int max = 0;
+    OnChange onChange;
+};
+
+// UCI option names are case insensitive
+struct CaseInsensitiveLess {
+    bool operator()(const std::string& a, const std::string& b) const;
+};
+
+class OptionsMap {
+public:
+    void add(const std::string& name, const Option& option);
+
+    // handles the remainder of "setoption name <id> [value <x>]"
+    void setoption(std::istream& is);
+
+    const Option& operator[](const std::string& name) const { return options.at(name); }
+
+    void print(std::ostream& os) const;
+
+private:
+    std::map<std::string, Option, CaseInsensitiveLess> options;
+};
+
+} // namespace UCIOptions
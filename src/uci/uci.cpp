@@ -10,16 +10,36 @@
 #include "../core/zobrist.h"
 #include "../core/magic.h"
 #include "../evaluation/evaluation.h"
+#include "../evaluation/nnue.h"
 
 // Don't redefine defaultFEN - it's already in position.h
 
 UCI::UCI() : pos(nullptr), tt() {
     pos = new Position("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1");
-    searcher = new Search::Searcher(*pos, tt);
+
+    options.add("Threads", UCIOptions::Option(1, 1, 256, [this](const UCIOptions::Option& o) {
+        threads.set(static_cast<size_t>(o.asInt()), tt);
+    }));
+    // only tells the GUI we understand "go ponder" and "ponderhit"
+    options.add("Ponder", UCIOptions::Option(false));
+    // the tt and the eval caches hold evaluations of the old function
+    options.add("Use NNUE", UCIOptions::Option(false, [this](const UCIOptions::Option& o) {
+        ASTROVE::nnue::enabled = o.asBool();
+        threads.newGame();
+        tt.clear();
+    }));
+    options.add("EvalFile", UCIOptions::Option("astrove.nnue", [this](const UCIOptions::Option& o) {
+        if (ASTROVE::nnue::load(o.asString())) {
+            std::cout << "info string NNUE loaded from " << o.asString() << "\n";
+            threads.newGame();
+            tt.clear();
+        }
+        else
+            std::cout << "info string NNUE file " << o.asString() << " not loaded, keeping the current network\n";
+    }));
 }
 
 UCI::~UCI() {
-    delete searcher;
     delete pos;
 }
 
@@ -35,21 +55,27 @@ void UCI::uciLoop() {
         iss >> command;
 
         if (command == "uci") {
-            std::cout << "id name Astrove\n";
-            std::cout << "id author Kirti Vardhan Bhushan\n";
-            std::cout << "uciok\n";
+            std::ostringstream ss;
+            ss << "id name Astrove\n";
+            ss << "id author Kirti Vardhan Bhushan\n";
+            options.print(ss);
+            ss << "uciok\n";
+            std::cout << ss.str();
         }
         else if (command == "isready") {
+            // answered right away, also while a search is running
             std::cout << "readyok\n";
         }
+        else if (command == "setoption") {
+            threads.waitForSearchFinished();
+            options.setoption(iss);
+        }
         else if (command == "ucinewgame") {
+            threads.newGame();
             tt.clear();
-
-            if (searcher) {
-                searcher->newGame();
-            }
         }
         else if (command == "position") {
+            // safe during a search: every worker searches its own copy
             std::string token;
             iss >> token;
 
@@ -101,6 +127,9 @@ void UCI::uciLoop() {
             std::cout << "info string Position set\n";
         }
         else if (command == "go") {
+            // a previous search has to be stopped by the GUI first
+            threads.waitForSearchFinished();
+
             // Prepare SearchLimits structure
             Search::SearchLimits limits;
             limits.depth = Search::MAX_PLY;
@@ -140,26 +169,37 @@ void UCI::uciLoop() {
                 else if (token == "infinite") {
                     limits.infinite = true;
                 }
+                else if (token == "ponder") {
+                    limits.ponder = true;
+                }
                 else if (token == "nodes") {
                     iss >> limits.nodes;
                 }
             }
 
-            // Call think() which handles search
-            searcher->think(limits);
-
+            // Every worker searches its own copy of the position, the
+            // main worker prints bestmove while we keep reading commands
+            threads.startThinking(*pos, limits, tt);
         }
         else if (command == "stop") {
-            searcher->stop();
+            threads.stop();
+        }
+        else if (command == "ponderhit") {
+            threads.ponderhit();
         }
         else if (command == "quit") {
-            searcher->stop();
+            threads.stop();
+            threads.waitForSearchFinished();
             break;
         }
         else if (command == "print") {
             pos->print();
         }
     }
+
+    // end of input acts like quit, never leave a search running
+    threads.stop();
+    threads.waitForSearchFinished();
 }
 
 Move UCI::parseMove(const std::string& moveUci) {
@@ -211,9 +251,16 @@ void UCI::bootEngine() {
     
     // Initialize evaluation tables
     ASTROVE::eval::InitializePieceSquareTable();
+    ASTROVE::nnue::init();
+
+    // a network file next to the engine replaces the embedded one
+    ASTROVE::nnue::load(options["EvalFile"].asString());
     
     // Initialize TT
     tt.init(64); // 64 MB
+
+    // Start the search threads (sleeping until the first "go")
+    threads.set(static_cast<size_t>(options["Threads"].asInt()), tt);
     
     std::cout << "Astrove UCI-compatible engine ready\n";
 }
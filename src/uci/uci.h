@@ -1,12 +1,13 @@
 #pragma once
 
-#include <thread>
 #include <sstream>
 #include "../board/position.h"
 #include "../table/tt.h"
 #include "../search/search.h"
+#include "../search/thread.h"
 #include "../board/movegen.h"
 #include "../core/zobrist.h"
+#include "options.h"
 
 extern Zobrist zobristInstance;
 
@@ -14,10 +15,10 @@ class UCI {
 public:
     Position* pos;
     TranspositionTable tt;
-    Search::Searcher* searcher;
+    Search::ThreadPool threads;
+    UCIOptions::OptionsMap options;
     MoveGenerator gen;
     std::istringstream iss;
-    std::thread searchThread;
 
     UCI();
     ~UCI();
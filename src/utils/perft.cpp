@@ -13,20 +13,19 @@ U64 perft(Position& pos, int depth, MoveGenerator& gen) {
         gen.generate_all_moves<Black>(pos, moves);
     }
 
+    // the generator is legal, the last ply is just a count
+    if (depth == 1) return moves.size();
+
     U64 nodes = 0;
 
     for (const Move& move : moves) {
         if (pos.sideToMove() == White) {
             pos.makemove<White>(move);
-            if (!pos.isSquareAttacked<Black>(pos.kingsq<White>())) {
-                nodes += perft(pos, depth - 1, gen);
-            }
+            nodes += perft(pos, depth - 1, gen);
             pos.unmakemove<White>(move);
         } else {
             pos.makemove<Black>(move);
-            if (!pos.isSquareAttacked<White>(pos.kingsq<Black>())) {
-                nodes += perft(pos, depth - 1, gen);
-            }
+            nodes += perft(pos, depth - 1, gen);
             pos.unmakemove<Black>(move);
         }
     }
@@ -51,23 +50,18 @@ void perftDivide(Position& pos, int depth, MoveGenerator& gen) {
     auto start = std::chrono::high_resolution_clock::now();
 
     for (const Move& move : moves) {
+        U64 childNodes;
         if (pos.sideToMove() == White) {
             pos.makemove<White>(move);
-            if (!pos.isSquareAttacked<Black>(pos.kingsq<White>())) {
-                U64 childNodes = perft(pos, depth - 1, gen);
-                std::cout << move.to_uci_string() << ": " << childNodes << "\n";
-                totalNodes += childNodes;
-            }
+            childNodes = perft(pos, depth - 1, gen);
             pos.unmakemove<White>(move);
         } else {
             pos.makemove<Black>(move);
-            if (!pos.isSquareAttacked<White>(pos.kingsq<Black>())) {
-                U64 childNodes = perft(pos, depth - 1, gen);
-                std::cout << move.to_uci_string() << ": " << childNodes << "\n";
-                totalNodes += childNodes;
-            }
+            childNodes = perft(pos, depth - 1, gen);
             pos.unmakemove<Black>(move);
         }
+        std::cout << move.to_uci_string() << ": " << childNodes << "\n";
+        totalNodes += childNodes;
     }
 
     auto end = std::chrono::high_resolution_clock::now();